@@ -1,414 +1,1047 @@
-    #include <stdio.h>
-    #include <stdlib.h>
-    #include <stdbool.h>
-    #include <math.h>
-
-    typedef struct {
-        int x, y;
-        int id;
-    } Point;
-
-    typedef struct {
-        Point p1, p2;
-    } Edge;
-
-    // 比较函数：按横坐标递增排序
-    int compare_points(const void *a, const void *b) {
-        Point *p1 = (Point *)a;
-        Point *p2 = (Point *)b;
-        if (p1->x != p2->x) return p1->x - p2->x;
-        return p1->y - p2->y;
-    }
-
-    // 计算叉积
-    int cross_product(Point p1, Point p2, Point p3) {
-        return (p2.x - p1.x) * (p3.y - p1.y) - (p2.y - p1.y) * (p3.x - p1.x);
-    }
-    /*例如P3: (6, 3)
-        P2: (6, 5)
-        P1: (7, 1)
-        叉积 = (6 - 7) * (3 - 1) - (5 - 1) * (6 - 7)
-            = (-1) * 2 - 4 * (-1)
-            = -2 + 4
-            = 2 > 0 （左转）
-        */
-        
-    // 计算两点距离的平方
-    double distance_sq(Point a, Point b) {
-        return (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y);
-    }
-
-    // 判断点是否在线段上（包括端点）
-    bool point_on_segment_include_endpoints(Point p, Point a, Point b) {
-        if (cross_product(a, b, p) != 0) return false;
-        return (p.x >= fmin(a.x, b.x) && p.x <= fmax(a.x, b.x) &&
-                p.y >= fmin(a.y, b.y) && p.y <= fmax(a.y, b.y));
-    }
-
-    // 判断边是否在边集合中
-    bool is_edge_in_set(Edge edge, Edge *edge_set, int count) {
-        for (int i = 0; i < count; i++) {
-            if ((edge.p1.id == edge_set[i].p1.id && edge.p2.id == edge_set[i].p2.id) ||
-                (edge.p1.id == edge_set[i].p2.id && edge.p2.id == edge_set[i].p1.id)) {
-                return true;
-            }
-        }
-        return false;
-    }
-
-    // 添加边到集合
-    void add_edge_to_set(Edge edge, Edge **edge_set, int *count, int *capacity) {
-        if (is_edge_in_set(edge, *edge_set, *count)) return;
-        if (*count >= *capacity) {
-            *capacity = (*capacity == 0) ? 20 : *capacity * 2;
-            *edge_set = realloc(*edge_set, *capacity * sizeof(Edge));
-        }
-        (*edge_set)[(*count)++] = edge;
-    }
-
-    // 凸包计算 - 保留所有共线点
-    void compute_convex_hull(Point *points, int n, Point **hull_points, int *hull_count) {
-        printf("=== 开始凸包计算 ===\n");
-        printf("输入点 (%d个): ", n);
-        for (int i = 0; i < n; i++) {
-            printf("P%d(%d,%d) ", points[i].id, points[i].x, points[i].y);
-        }
-        printf("\n");
-        
-        if (n <= 3) {
-            *hull_count = n;
-            *hull_points = malloc(n * sizeof(Point));
-            for (int i = 0; i < n; i++) (*hull_points)[i] = points[i];
-            printf("点数≤3，直接返回所有点\n");
-            printf("凸包点: ");
-            for (int i = 0; i < n; i++) printf("P%d ", (*hull_points)[i].id);
-            printf("\n=== 结束凸包计算 ===\n\n");
-            return;
-        }
-        
-        // 复制点集，避免修改原数据
-        Point *copy = malloc(n * sizeof(Point));
-        for (int i = 0; i < n; i++) copy[i] = points[i];
-        
-        // 找到最左下角的点
-        int start = 0;
-        for (int i = 1; i < n; i++) {
-            if (copy[i].y < copy[start].y || 
-                (copy[i].y == copy[start].y && copy[i].x < copy[start].x)) {
-                start = i;
-            }
-        }
-        printf("最左下角点: P%d(%d,%d)\n", copy[start].id, copy[start].x, copy[start].y);
-        
-        // 将起始点交换到第一个位置
-        Point temp = copy[0];
-        copy[0] = copy[start];
-        copy[start] = temp;
-        
-        // 极角排序
-        printf("极角排序过程:\n");
-        for (int i = 1; i < n; i++) {
-            for (int j = i + 1; j < n; j++) {
-                int orient = cross_product(copy[0], copy[i], copy[j]);
-                printf("  P%d-P%d-P%d 叉积=%d ", copy[0].id, copy[i].id, copy[j].id, orient);
-                
-                if (orient < 0) {
-                    printf("→ 逆时针，交换P%d和P%d\n", copy[i].id, copy[j].id);
-                    Point temp = copy[i];
-                    copy[i] = copy[j];
-                    copy[j] = temp;
-                } else if (orient == 0) {
-                    double dist_i = distance_sq(copy[0], copy[i]);
-                    double dist_j = distance_sq(copy[0], copy[j]);
-                    printf("→ 共线，距离P%d=%.1f P%d=%.1f ", copy[i].id, dist_i, copy[j].id, dist_j);
-                    if (dist_i < dist_j) {
-                        printf("→ 交换(远的在前)\n");
-                        Point temp = copy[i];
-                        copy[i] = copy[j];
-                        copy[j] = temp;
-                    } else {
-                        printf("→ 不交换\n");
-                    }
-                } else {
-                    printf("→ 顺时针，不交换\n");
-                }
-            }
-        }
-        
-        printf("排序后点顺序: ");
-        for (int i = 0; i < n; i++) {
-            printf("P%d ", copy[i].id);
-        }
-        printf("\n");
-        
-        // Graham Scan - 保留所有共线点
-        Point *stack = malloc(n * sizeof(Point));
-        int stack_size = 0;
-        
-        stack[stack_size++] = copy[0];
-        stack[stack_size++] = copy[1];
-        
-        printf("Graham Scan过程:\n");
-        printf("  初始栈: ");
-        for (int i = 0; i < stack_size; i++) printf("P%d ", stack[i].id);
-        printf("\n");
-        
-        for (int i = 2; i < n; i++) {
-            printf("  处理点 P%d: ", copy[i].id);
-            
-            while (stack_size >= 2) {
-                Point p1 = stack[stack_size - 2];
-                Point p2 = stack[stack_size - 1];
-                Point p3 = copy[i];
-                
-                int orient = cross_product(p1, p2, p3);
-                printf("转向(P%d-P%d-P%d)=%d ", p1.id, p2.id, p3.id, orient);
-                
-                if (orient < 0) {
-                    printf("→ 右转，弹出P%d ", stack[stack_size-1].id);
-                    stack_size--;
-                } else {
-                    printf("→ 左转/共线，保留 ");
-                    break;
-                }
-            }
-            
-            stack[stack_size++] = copy[i];
-            printf("→ 压入P%d\n", copy[i].id);
-            printf("    当前栈: ");
-            for (int j = 0; j < stack_size; j++) printf("P%d ", stack[j].id);
-            printf("\n");
-        }
-        
-        *hull_count = stack_size;
-        *hull_points = malloc(stack_size * sizeof(Point));
-        for (int i = 0; i < stack_size; i++) {
-            (*hull_points)[i] = stack[i];
-        }
-        
-        printf("最终凸包点 (%d个): ", stack_size);
-        for (int i = 0; i < stack_size; i++) printf("P%d ", (*hull_points)[i].id);
-        printf("\n=== 结束凸包计算 ===\n\n");
-        
-        free(stack);
-        free(copy);
-    }
-
-    // 构建凸包边集
-    void build_hull_edges(Point *hull_points, int hull_count, Edge **hull_edges, int *edge_count) {
-        *edge_count = hull_count;
-        *hull_edges = malloc(hull_count * sizeof(Edge));
-        for (int i = 0; i < hull_count; i++) {
-            (*hull_edges)[i] = (Edge){hull_points[i], hull_points[(i + 1) % hull_count]};
-        }
-    }
-
-    // 可见性检查
-    bool is_visible(Point Pi, Point Pk, Point *hull_points, int hull_count, Edge *hull_edges, int edge_count, Edge *existing_edges, int existing_count) {
-        // 1. 检查是否与凸包边在非端点处相交
-        for (int j = 0; j < edge_count; j++) {
-            Edge e = hull_edges[j];
-            if (Pk.id == e.p1.id || Pk.id == e.p2.id) continue;
-            
-            Point a1 = Pi, a2 = Pk;
-            Point b1 = e.p1, b2 = e.p2;
-            
-            int d1 = cross_product(b1, b2, a1);
-            int d2 = cross_product(b1, b2, a2);
-            int d3 = cross_product(a1, a2, b1);
-            int d4 = cross_product(a1, a2, b2);
-            
-            if (((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) &&
-                ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0))) {
-                return false;
-            }
-        }
-        
-        // 2. 检查是否与已存在边在非端点处相交
-        for (int j = 0; j < existing_count; j++) {
-            Edge e = existing_edges[j];
-            if (Pi.id == e.p1.id || Pi.id == e.p2.id || 
-                Pk.id == e.p1.id || Pk.id == e.p2.id) continue;
-            
-            Point a1 = Pi, a2 = Pk;
-            Point b1 = e.p1, b2 = e.p2;
-            
-            int d1 = cross_product(b1, b2, a1);
-            int d2 = cross_product(b1, b2, a2);
-            int d3 = cross_product(a1, a2, b1);
-            int d4 = cross_product(a1, a2, b2);
-            
-            if (((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) &&
-                ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0))) {
-                return false;
-            }
-        }
-        
-        // 3. 检查是否有其他凸包点在Pi-Pk线段上（阻挡视线）
-        for (int m = 0; m < hull_count; m++) {
-            Point Pm = hull_points[m];
-            if (Pm.id == Pi.id || Pm.id == Pk.id) continue;
-            
-            if (point_on_segment_include_endpoints(Pm, Pi, Pk)) {
-                double dist_PiPm = distance_sq(Pi, Pm);
-                double dist_PiPk = distance_sq(Pi, Pk);
-                
-                if (dist_PiPm < dist_PiPk) {
-                    return false;
-                }
-            }
-        }
-        
-        return true;
-    }
-
-    // 主算法
-    Edge* build_visible_network(Point *points, int n, int *total_edge_count) {
-        qsort(points, n, sizeof(Point), compare_points);
-        for (int i = 0; i < n; i++) points[i].id = i + 1;
-        
-        int E_capacity = 50;
-        Edge *E = malloc(E_capacity * sizeof(Edge));
-        int E_count = 0;
-        
-        Point *V = malloc(n * sizeof(Point));
-        int V_count = 0;
-        
-        Point *CP = NULL;
-        int CP_count = 0;
-        Edge *CE = NULL;
-        int CE_count = 0;
-        
-        // 初始化最后三个点
-        if (n >= 3) {
-            V[V_count++] = points[n-1];
-            V[V_count++] = points[n-2];
-            V[V_count++] = points[n-3];
-            
-            printf("初始化最后三个点: P%d, P%d, P%d\n", 
-                points[n-1].id, points[n-2].id, points[n-3].id);
-            
-            compute_convex_hull(V, V_count, &CP, &CP_count);
-            build_hull_edges(CP, CP_count, &CE, &CE_count);
-            
-            for (int i = 0; i < CE_count; i++) {
-                add_edge_to_set(CE[i], &E, &E_count, &E_capacity);
-            }
-        }
-        
-        // 从右向左扫描
-        for (int i = n-4; i >= 0; i--) {
-            Point Pi = points[i];
-            
-            printf(">>> 处理点 P%d\n", Pi.id);
-            printf("当前V中的点 (%d个): ", V_count);
-            for (int j = 0; j < V_count; j++) printf("P%d ", V[j].id);
-            printf("\n");
-            
-            printf("可见点检查: ");
-            for (int k = 0; k < CP_count; k++) {
-                Point Pk = CP[k];
-                if (is_visible(Pi, Pk, CP, CP_count, CE, CE_count, E, E_count)) {
-                    Edge new_edge = {Pi, Pk};
-                    add_edge_to_set(new_edge, &E, &E_count, &E_capacity);
-                    printf("P%d ", Pk.id);
-                }
-            }
-            printf("\n");
-            
-            V[V_count++] = Pi;
-            
-            if (CP != NULL) free(CP);
-            if (CE != NULL) free(CE);
-            compute_convex_hull(V, V_count, &CP, &CP_count);
-            build_hull_edges(CP, CP_count, &CE, &CE_count);
-        }
-        
-        *total_edge_count = E_count;
-        free(V);
-        if (CP != NULL) free(CP);
-        if (CE != NULL) free(CE);
-        return E;
-    }
-
-    // 检查是否包含特定边
-    bool contains_edge(Edge *edges, int count, int id1, int id2) {
-        for (int i = 0; i < count; i++) {
-            if ((edges[i].p1.id == id1 && edges[i].p2.id == id2) ||
-                (edges[i].p1.id == id2 && edges[i].p2.id == id1)) {
-                return true;
-            }
-        }
-        return false;
-    }
-
-    // 测试函数
-    int main() {
-        Point points[] = {
-            {1, 4}, {2, 2}, {3, 3}, {3, 4}, {4, 2}, 
-            {5, 4}, {6, 2}, {6, 3}, {6, 5}, {7, 1}
-        };
-        int n = sizeof(points) / sizeof(points[0]);
-        
-        printf("输入点集 (%d 个点):\n", n);
-        for (int i = 0; i < n; i++) {
-            printf("P%d: (%d, %d)\n", i + 1, points[i].x, points[i].y);
-        }
-        printf("\n");
-        
-        int total_edges;
-        Edge *network_edges = build_visible_network(points, n, &total_edges);
-        
-        printf("\n最终可见网络的所有边 (%d 条):\n", total_edges);
-        for (int i = 0; i < total_edges; i++) {
-            printf("边 %2d: P%d-P%d\n", i + 1, network_edges[i].p1.id, network_edges[i].p2.id);
-        }
-        
-        // 检查预期的23条边
-        printf("\n检查预期边:\n");
-        int expected_edges[23][2] = {
-            {8,9}, {9,10}, {8,10}, {7,8}, {7,10}, {6,7}, {6,8}, {6,9},
-            {5,6}, {5,7}, {5,10}, {4,5}, {4,6}, {4,9}, {3,4}, {3,5},
-            {2,3}, {2,4}, {2,5}, {2,10}, {1,2}, {1,4}, {1,9}
-        };
-        
-        int missing_count = 0;
-        int extra_count = 0;
-        
-        for (int i = 0; i < 23; i++) {
-            int id1 = expected_edges[i][0];
-            int id2 = expected_edges[i][1];
-            if (!contains_edge(network_edges, total_edges, id1, id2)) {
-                printf("缺少边: P%d-P%d\n", id1, id2);
-                missing_count++;
-            }
-        }
-        
-        // 检查多余的边
-        printf("\n检查多余边:\n");
-        for (int i = 0; i < total_edges; i++) {
-            int id1 = network_edges[i].p1.id;
-            int id2 = network_edges[i].p2.id;
-            bool found = false;
-            for (int j = 0; j < 23; j++) {
-                if ((id1 == expected_edges[j][0] && id2 == expected_edges[j][1]) ||
-                    (id1 == expected_edges[j][1] && id2 == expected_edges[j][0])) {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) {
-                printf("多余边: P%d-P%d\n", id1, id2);
-                extra_count++;
-            }
-        }
-        
-        if (missing_count == 0 && extra_count == 0) {
-            printf("✓ 所有预期边都存在，没有多余边！\n");
-        } else {
-            printf("✗ 缺少 %d 条边，多出 %d 条边\n", missing_count, extra_count);
-        }
-        
-        free(network_edges);
-        return 0;
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include <string.h>
+    #include <math.h>
+    #include <pthread.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include "trace.h"
+
+    typedef struct {
+        int x, y;
+        int id;
+    } Point;
+
+    // 比较函数：按横坐标递增排序（不做减法，避免大坐标溢出）
+    int compare_points(const void *a, const void *b) {
+        Point *p1 = (Point *)a;
+        Point *p2 = (Point *)b;
+        if (p1->x != p2->x) return (p1->x > p2->x) - (p1->x < p2->x);
+        return (p1->y > p2->y) - (p1->y < p2->y);
+    }
+
+    // 叉积的计算精度，每批输入按坐标跨度选一次，尽量用最便宜的运算
+    //   PRECISION_INT32: 跨度 <= 32767，两个乘积之差不超过 2^31，直接用 int
+    //   PRECISION_INT64: 跨度 < 2^31，用 int64_t
+    //   PRECISION_EXACT: 任意 int 坐标，先用 double 计算并做误差过滤，无法判定符号时用 __int128 精确计算
+    typedef enum {
+        PRECISION_INT32,
+        PRECISION_INT64,
+        PRECISION_EXACT
+    } Precision;
+
+    // 点集的包围盒
+    typedef struct {
+        int min_x, min_y;
+        int max_x, max_y;
+    } BoundingBox;
+
+    BoundingBox bounding_box(const Point *points, int n) {
+        BoundingBox box = {0, 0, 0, 0};
+        if (n == 0) return box;
+        box.min_x = box.max_x = points[0].x;
+        box.min_y = box.max_y = points[0].y;
+        for (int i = 1; i < n; i++) {
+            if (points[i].x < box.min_x) box.min_x = points[i].x;
+            if (points[i].x > box.max_x) box.max_x = points[i].x;
+            if (points[i].y < box.min_y) box.min_y = points[i].y;
+            if (points[i].y > box.max_y) box.max_y = points[i].y;
+        }
+        return box;
+    }
+
+    Precision select_precision(BoundingBox box) {
+        int min_x = box.min_x, max_x = box.max_x;
+        int min_y = box.min_y, max_y = box.max_y;
+        int64_t span_x = (int64_t)max_x - min_x;
+        int64_t span_y = (int64_t)max_y - min_y;
+        int64_t span = span_x > span_y ? span_x : span_y;
+        if (span <= 32767) return PRECISION_INT32;
+        if (span <= INT32_MAX) return PRECISION_INT64;
+        return PRECISION_EXACT;
+    }
+
+    // 计算叉积（int 版本，只在 PRECISION_INT32 下不溢出）
+    int cross_product(Point p1, Point p2, Point p3) {
+        return (p2.x - p1.x) * (p3.y - p1.y) - (p2.y - p1.y) * (p3.x - p1.x);
+    }
+
+    int sign_of(int64_t v) { return (v > 0) - (v < 0); }
+
+    int orientation_exact(Point p1, Point p2, Point p3) {
+        int64_t ax = (int64_t)p2.x - p1.x, ay = (int64_t)p2.y - p1.y;
+        int64_t bx = (int64_t)p3.x - p1.x, by = (int64_t)p3.y - p1.y;
+        // 差值不超过 2^32，转成 double 无误差；两次乘法和一次减法的舍入误差不超过 errbound
+        double left = (double)ax * (double)by;
+        double right = (double)ay * (double)bx;
+        double det = left - right;
+        double errbound = 3.3306690738754716e-16 * (fabs(left) + fabs(right));
+        if (det > errbound) return 1;
+        if (-det > errbound) return -1;
+        __int128 exact = (__int128)ax * by - (__int128)ay * bx;
+        return (exact > 0) - (exact < 0);
+    }
+
+    // 叉积符号：>0 左转，<0 右转，0 共线
+    int orientation(Precision precision, Point p1, Point p2, Point p3) {
+        switch (precision) {
+        case PRECISION_INT32:
+            return sign_of(cross_product(p1, p2, p3));
+        case PRECISION_INT64:
+            return sign_of(((int64_t)p2.x - p1.x) * ((int64_t)p3.y - p1.y) -
+                           ((int64_t)p2.y - p1.y) * ((int64_t)p3.x - p1.x));
+        default:
+            return orientation_exact(p1, p2, p3);
+        }
+    }
+    /*例如P3: (6, 3)
+        P2: (6, 5)
+        P1: (7, 1)
+        叉积 = (6 - 7) * (3 - 1) - (5 - 1) * (6 - 7)
+            = (-1) * 2 - 4 * (-1)
+            = -2 + 4
+            = 2 > 0 （左转）
+        */
+        
+    // 临时内存池（分块的线性分配器）
+    // 扫描过程中的缓冲区（凸包链、V、可见链）都从这里分配：按点数预先申请一次，
+    // 扫描中不再调用 malloc/free；一批结束后 arena_reset 复用同一块内存。
+    // 容量不够时再向系统申请新块，high_water 记录峰值用量，可据此调整初始大小。
+    typedef struct ArenaChunk {
+        struct ArenaChunk *next;
+        size_t size;
+        size_t used;
+        char data[];
+    } ArenaChunk;
+
+    typedef struct {
+        ArenaChunk *first;
+        ArenaChunk *current;
+        size_t used;            // 当前用量（各块之和）
+        size_t high_water;      // 历史峰值
+        void *last;             // 最近一次分配的地址，只有它能原地扩容
+    } ScratchArena;
+
+    #define ARENA_ALIGN 16
+
+    ArenaChunk *arena_new_chunk(size_t size) {
+        ArenaChunk *chunk = malloc(sizeof(ArenaChunk) + size);
+        chunk->next = NULL;
+        chunk->size = size;
+        chunk->used = 0;
+        return chunk;
+    }
+
+    void arena_init(ScratchArena *arena, size_t size) {
+        arena->first = arena_new_chunk(size < 4096 ? 4096 : size);
+        arena->current = arena->first;
+        arena->used = 0;
+        arena->high_water = 0;
+        arena->last = NULL;
+    }
+
+    void arena_free(ScratchArena *arena) {
+        ArenaChunk *chunk = arena->first;
+        while (chunk != NULL) {
+            ArenaChunk *next = chunk->next;
+            free(chunk);
+            chunk = next;
+        }
+        arena->first = arena->current = NULL;
+    }
+
+    // 释放全部分配，保留已申请的块（和峰值记录）供下一批使用
+    void arena_reset(ScratchArena *arena) {
+        for (ArenaChunk *chunk = arena->first; chunk != NULL; chunk = chunk->next) chunk->used = 0;
+        arena->current = arena->first;
+        arena->used = 0;
+        arena->last = NULL;
+    }
+
+    void *arena_alloc(ScratchArena *arena, size_t bytes) {
+        bytes = (bytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+        while (arena->current->used + bytes > arena->current->size) {
+            if (arena->current->next == NULL) {
+                size_t size = arena->current->size * 2;
+                if (size < bytes) size = bytes;
+                arena->current->next = arena_new_chunk(size);
+            }
+            arena->current = arena->current->next;
+        }
+        void *ptr = arena->current->data + arena->current->used;
+        arena->current->used += bytes;
+        arena->used += bytes;
+        if (arena->used > arena->high_water) arena->high_water = arena->used;
+        arena->last = ptr;
+        return ptr;
+    }
+
+    // 扩容：ptr 是最近一次分配且当前块放得下时原地扩展，否则重新分配并拷贝（旧空间在 reset 时回收）
+    void *arena_realloc(ScratchArena *arena, void *ptr, size_t old_bytes, size_t new_bytes) {
+        old_bytes = (old_bytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+        new_bytes = (new_bytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+        ArenaChunk *chunk = arena->current;
+        if (ptr != NULL && ptr == arena->last &&
+            (char *)ptr + new_bytes <= chunk->data + chunk->size) {
+            chunk->used += new_bytes - old_bytes;
+            arena->used += new_bytes - old_bytes;
+            if (arena->used > arena->high_water) arena->high_water = arena->used;
+            return ptr;
+        }
+        void *fresh = arena_alloc(arena, new_bytes);
+        if (ptr != NULL) memcpy(fresh, ptr, old_bytes);
+        return fresh;
+    }
+
+    size_t arena_high_water(const ScratchArena *arena) {
+        return arena->high_water;
+    }
+
+    // 边集合 - 只保存端点 id
+    // 每条边规范化为 (min_id, max_id) 并打包成 64 位键，按插入顺序存放在 edges 中；
+    // slots 是开放寻址（线性探测）哈希表，存放 edges 的下标，用于 O(1) 去重与查询。
+    typedef struct {
+        uint64_t *edges;
+        int count;
+        int capacity;
+        int *slots;         // -1 表示空槽
+        int slot_mask;      // 槽数 - 1，槽数为 2 的幂
+        bool mapped;        // edges/slots 指向快照的内存映射，不能 realloc/free，扩容时先拷出
+    } EdgeSet;
+
+    uint64_t edge_key(int id1, int id2) {
+        if (id1 > id2) { int t = id1; id1 = id2; id2 = t; }
+        return ((uint64_t)(uint32_t)id1 << 32) | (uint32_t)id2;
+    }
+
+    int edge_first(uint64_t key) { return (int)(key >> 32); }
+    int edge_second(uint64_t key) { return (int)(uint32_t)key; }
+
+    int edge_slot(uint64_t key, int slot_mask) {
+        return (int)((key * 0x9E3779B97F4A7C15ULL) >> 32) & slot_mask;
+    }
+
+    void edge_set_init(EdgeSet *set, int capacity) {
+        int slot_count = 16;
+        while (slot_count < capacity * 2) slot_count *= 2;
+        set->edges = malloc(capacity * sizeof(uint64_t));
+        set->count = 0;
+        set->capacity = capacity;
+        set->slots = malloc(slot_count * sizeof(int));
+        set->slot_mask = slot_count - 1;
+        for (int i = 0; i < slot_count; i++) set->slots[i] = -1;
+        set->mapped = false;
+    }
+
+    void edge_set_free(EdgeSet *set) {
+        if (set->mapped) return;
+        free(set->edges);
+        free(set->slots);
+    }
+
+    // 把指向快照映射的 edges/slots 拷到自己申请的内存中，之后可以正常扩容和释放
+    void edge_set_detach(EdgeSet *set) {
+        if (!set->mapped) return;
+        uint64_t *edges = malloc(set->capacity * sizeof(uint64_t));
+        int *slots = malloc((set->slot_mask + 1) * sizeof(int));
+        memcpy(edges, set->edges, set->count * sizeof(uint64_t));
+        memcpy(slots, set->slots, (set->slot_mask + 1) * sizeof(int));
+        set->edges = edges;
+        set->slots = slots;
+        set->mapped = false;
+    }
+
+    // 判断边是否在边集合中
+    bool edge_set_contains(const EdgeSet *set, int id1, int id2) {
+        uint64_t key = edge_key(id1, id2);
+        for (int s = edge_slot(key, set->slot_mask); set->slots[s] != -1; s = (s + 1) & set->slot_mask) {
+            if (set->edges[set->slots[s]] == key) return true;
+        }
+        return false;
+    }
+
+    // 装载因子超过 1/2 时槽数翻倍并重新散列
+    void edge_set_rehash(EdgeSet *set) {
+        edge_set_detach(set);
+        int slot_count = (set->slot_mask + 1) * 2;
+        free(set->slots);
+        set->slots = malloc(slot_count * sizeof(int));
+        set->slot_mask = slot_count - 1;
+        for (int i = 0; i < slot_count; i++) set->slots[i] = -1;
+        for (int i = 0; i < set->count; i++) {
+            int s = edge_slot(set->edges[i], set->slot_mask);
+            while (set->slots[s] != -1) s = (s + 1) & set->slot_mask;
+            set->slots[s] = i;
+        }
+    }
+
+    // 添加边到集合，已存在则忽略；返回是否新插入
+    bool edge_set_add(EdgeSet *set, int id1, int id2) {
+        uint64_t key = edge_key(id1, id2);
+        int s = edge_slot(key, set->slot_mask);
+        for (; set->slots[s] != -1; s = (s + 1) & set->slot_mask) {
+            if (set->edges[set->slots[s]] == key) return false;
+        }
+        if (set->count >= set->capacity) {
+            edge_set_detach(set);
+            set->capacity = (set->capacity == 0) ? 20 : set->capacity * 2;
+            set->edges = realloc(set->edges, set->capacity * sizeof(uint64_t));
+        }
+        set->slots[s] = set->count;
+        set->edges[set->count++] = key;
+        if (set->count * 2 > set->slot_mask + 1) edge_set_rehash(set);
+        return true;
+    }
+
+    // 增量凸包 - 保留所有共线点
+    // 扫描从右向左插入点（按 x 递减，x 相同按 y 递减），每个新点都是当前最左点，
+    // 因此只需在上、下两条链的栈顶弹出/压入，均摊 O(1)。
+    // 两条链都以最右点为栈底、最左点为栈顶。
+    typedef struct {
+        Point *upper;       // 上链：右 -> 左，逆时针方向
+        Point *lower;       // 下链：右 -> 左，顺时针方向
+        int upper_count;
+        int lower_count;
+        int count;          // 已插入的点数
+        Point lowest;       // 最下（y 相同取最左）的点，输出凸包时的起点
+        Precision precision;
+        int capacity;
+        ScratchArena *arena;    // upper/lower 所在的内存池
+    } IncrementalHull;
+
+    void hull_init(IncrementalHull *hull, int capacity, Precision precision, ScratchArena *arena) {
+        if (capacity < 4) capacity = 4;
+        hull->arena = arena;
+        hull->upper = arena_alloc(arena, capacity * sizeof(Point));
+        hull->lower = arena_alloc(arena, capacity * sizeof(Point));
+        hull->capacity = capacity;
+        hull->upper_count = 0;
+        hull->lower_count = 0;
+        hull->count = 0;
+        hull->precision = precision;
+    }
+
+    // 插入新的最左点：只有严格右转（上链）/ 左转（下链）才弹出，共线点保留
+    void hull_insert(IncrementalHull *hull, Point p) {
+        if (hull->count >= hull->capacity) {
+            size_t old_bytes = hull->capacity * sizeof(Point);
+            hull->capacity *= 2;
+            hull->upper = arena_realloc(hull->arena, hull->upper, old_bytes, hull->capacity * sizeof(Point));
+            hull->lower = arena_realloc(hull->arena, hull->lower, old_bytes, hull->capacity * sizeof(Point));
+        }
+        while (hull->upper_count >= 2 &&
+               orientation(hull->precision, hull->upper[hull->upper_count - 2], hull->upper[hull->upper_count - 1], p) < 0) {
+            hull->upper_count--;
+        }
+        hull->upper[hull->upper_count++] = p;
+        
+        while (hull->lower_count >= 2 &&
+               orientation(hull->precision, hull->lower[hull->lower_count - 2], hull->lower[hull->lower_count - 1], p) > 0) {
+            hull->lower_count--;
+        }
+        hull->lower[hull->lower_count++] = p;
+        
+        if (hull->count == 0 || p.y < hull->lowest.y ||
+            (p.y == hull->lowest.y && p.x < hull->lowest.x)) {
+            hull->lowest = p;
+        }
+        hull->count++;
+    }
+
+    // 复制凸包状态到 arena 中的新缓冲区，容量至少为 capacity
+    void hull_clone(IncrementalHull *dst, const IncrementalHull *src, int capacity, ScratchArena *arena) {
+        if (capacity < src->count) capacity = src->count;
+        hull_init(dst, capacity, src->precision, arena);
+        memcpy(dst->upper, src->upper, src->upper_count * sizeof(Point));
+        memcpy(dst->lower, src->lower, src->lower_count * sizeof(Point));
+        dst->upper_count = src->upper_count;
+        dst->lower_count = src->lower_count;
+        dst->count = src->count;
+        dst->lowest = src->lowest;
+    }
+
+    // 翻转 points[begin, end)
+    void reverse_points(Point *points, int begin, int end) {
+        for (int i = begin, j = end - 1; i < j; i++, j--) {
+            Point temp = points[i];
+            points[i] = points[j];
+            points[j] = temp;
+        }
+    }
+
+    // 按逆时针顺序输出凸包点（从最下方的点开始，与 Graham Scan 的输出顺序一致）
+    // hull_points 由调用者分配，容量不小于已插入点数
+    void hull_collect(const IncrementalHull *hull, Point *hull_points, int *hull_count) {
+        // 所有点共线时上下链相同，只输出下链
+        bool flat = hull->upper_count == hull->count && hull->lower_count == hull->count;
+        int count = hull->lower_count + (flat ? 0 : hull->upper_count - 2);
+        
+        // 最下方的点一定在下链上
+        int start = 0;
+        while (hull->lower[hull->lower_count - 1 - start].id != hull->lowest.id) start++;
+        
+        int k = 0;
+        // 下链从左到右
+        for (int i = hull->lower_count - 1; i >= 0; i--, k++) {
+            hull_points[(k - start + count) % count] = hull->lower[i];
+        }
+        // 上链从右到左，去掉与下链共享的两个端点
+        if (!flat) {
+            for (int i = 1; i < hull->upper_count - 1; i++, k++) {
+                hull_points[(k - start + count) % count] = hull->upper[i];
+            }
+        }
+        *hull_count = count;
+    }
+
+    // 查询 Pi 在当前凸包上的可见链
+    // Pi 严格位于凸包左侧，可见点是一段连续的链：所有"正对" Pi 的凸包边（Pi 严格在其外侧）的端点。
+    // 沿上、下链从最左点出发，正对的边构成前缀，因此用二分查找定位两个切点，O(log h)。
+    // 与 Pi 共线的边（视线擦边）不算正对，其远端点被近端点阻挡，从而在链端处理共线阻挡。
+    // 结果按逆时针顺序（从最下方的点开始）写入 chain，容量不小于已插入点数
+    void hull_visible_chain(const IncrementalHull *hull, Point Pi, Point *chain, int *chain_count) {
+        bool flat = hull->upper_count == hull->count && hull->lower_count == hull->count;
+        Point L = hull->lower[hull->lower_count - 1];
+        
+        if (flat) {
+            // 所有点共线：Pi 在该直线上时只能看到最近的 L，否则全部可见
+            if (orientation(hull->precision, L, hull->lower[0], Pi) == 0) {
+                chain[0] = L;
+                *chain_count = 1;
+            } else {
+                hull_collect(hull, chain, chain_count);
+            }
+            return;
+        }
+        
+        // 下链边 (lower[j], lower[j-1]) 逆时针，Pi 在其右侧为正对；找最小的正对下标
+        int lo = 1, hi = hull->lower_count;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (orientation(hull->precision, hull->lower[mid], hull->lower[mid - 1], Pi) < 0) hi = mid;
+            else lo = mid + 1;
+        }
+        int lower_tangent = lo - 1;
+        
+        // 上链边 (upper[j], upper[j-1]) 顺时针，Pi 在其左侧为正对
+        lo = 1, hi = hull->upper_count;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (orientation(hull->precision, hull->upper[mid], hull->upper[mid - 1], Pi) > 0) hi = mid;
+            else lo = mid + 1;
+        }
+        int upper_tangent = lo - 1;
+        
+        // 逆时针：上切点 -> L -> 下切点
+        int count = 0;
+        int start = -1;
+        for (int i = upper_tangent; i < hull->upper_count; i++) {
+            chain[count++] = hull->upper[i];
+        }
+        for (int i = hull->lower_count - 2; i >= lower_tangent; i--) {
+            chain[count++] = hull->lower[i];
+        }
+        for (int i = 0; i < count; i++) {
+            if (chain[i].id == hull->lowest.id) start = i;
+        }
+        *chain_count = count;
+        
+        // 最下方的点在链中时，旋转到以它开头，保持与凸包输出顺序一致
+        if (start > 0) {
+            reverse_points(chain, 0, start);
+            reverse_points(chain, start, count);
+            reverse_points(chain, 0, count);
+        }
+    }
+
+    // 流式可见网络引擎
+    // 保存扫描状态（V、增量凸包、边集合），点按扫描顺序（x 递减，x 相同时 y 递减）逐个到达，
+    // 每插入一个点只做这一步的工作，新产生的边通过 on_edge 回调按加入顺序输出。
+    // 点的 id 由调用者指定，需唯一且非负。
+    //
+    // 可见链上的点 Pk 满足：线段 Pi-Pk 与已插入点的闭凸包只交于 Pk（正对的边严格在 Pi 一侧，
+    // 与 Pi 共线的擦边的远端点已被排除），而已存在的边都在这个凸包内，所以 Pi-Pk 不会与已存在的边相交。
+    // 共线点造成的阻挡全部由 hull_visible_chain 的切点二分处理，每步 O(log h)，可见链直接加边。
+
+    typedef void (*EdgeCallback)(void *context, int id1, int id2);
+
+    typedef struct {
+        Point *V;
+        int V_count;
+        int V_capacity;
+        IncrementalHull hull;
+        EdgeSet edges;
+        BoundingBox box;                // 已声明或已到达的点的包围盒，决定计算精度
+        Precision precision;
+        // 每一步的临时缓冲区，容量随 V 增长
+        Point *CP;
+        Point *chain;
+        EdgeCallback on_edge;
+        void *context;
+        ScratchArena *arena;            // 上面各缓冲区和凸包所在的内存池
+        ScratchArena own_arena;         // 调用者没有提供内存池时使用
+        bool owns_arena;
+        void *snapshot;                 // 从快照恢复时的内存映射（V、凸包、边集合指向其中），否则为 NULL
+        size_t snapshot_bytes;
+    } VisibleNetworkEngine;
+
+    // n 个点的扫描预计需要的临时内存字节数，用于预先分配 ScratchArena
+    size_t visible_network_scratch_bytes(int n) {
+        if (n < 4) n = 4;
+        return 5 * (size_t)n * sizeof(Point) + 16 * ARENA_ALIGN;   // V、CP、chain、凸包上下链
+    }
+
+    // box 为预计的坐标范围（决定初始计算精度），expected_count 为预计点数（决定初始容量）；
+    // arena 为 NULL 时引擎自建内存池；否则从 arena 分配，引擎释放后由调用者 arena_reset
+    void engine_init(VisibleNetworkEngine *engine, BoundingBox box, int expected_count,
+                     EdgeCallback on_edge, void *context, ScratchArena *arena) {
+        int capacity = expected_count < 4 ? 4 : expected_count;
+        engine->owns_arena = arena == NULL;
+        if (engine->owns_arena) {
+            arena_init(&engine->own_arena, visible_network_scratch_bytes(capacity));
+            arena = &engine->own_arena;
+        }
+        engine->arena = arena;
+        engine->V = arena_alloc(arena, capacity * sizeof(Point));
+        engine->V_count = 0;
+        engine->V_capacity = capacity;
+        engine->box = box;
+        engine->precision = select_precision(box);
+        hull_init(&engine->hull, capacity, engine->precision, arena);
+        edge_set_init(&engine->edges, 3 * capacity);
+        engine->CP = arena_alloc(arena, capacity * sizeof(Point));
+        engine->chain = arena_alloc(arena, capacity * sizeof(Point));
+        engine->on_edge = on_edge;
+        engine->context = context;
+        engine->snapshot = NULL;
+        engine->snapshot_bytes = 0;
+    }
+
+    void engine_free(VisibleNetworkEngine *engine) {
+        edge_set_free(&engine->edges);
+        if (engine->owns_arena) arena_free(&engine->own_arena);
+        if (engine->snapshot != NULL) munmap(engine->snapshot, engine->snapshot_bytes);
+    }
+
+    // 把边集合的所有权转交给调用者，之后引擎不能再插入点
+    void engine_take_edges(VisibleNetworkEngine *engine, EdgeSet *E) {
+        edge_set_detach(&engine->edges);
+        *E = engine->edges;
+        engine->edges.edges = NULL;
+        engine->edges.slots = NULL;
+    }
+
+    void engine_emit_edge(VisibleNetworkEngine *engine, Point a, Point b) {
+        bool added = edge_set_add(&engine->edges, a.id, b.id);
+        if (added && engine->on_edge != NULL) {
+            engine->on_edge(engine->context, a.id, b.id);
+        }
+    }
+
+    // 插入下一个点；p 不在扫描顺序上（不在已插入点的左侧）时拒绝并返回 false
+    bool engine_insert(VisibleNetworkEngine *engine, Point p) {
+        if (engine->V_count > 0) {
+            Point last = engine->V[engine->V_count - 1];
+            if (p.x > last.x || (p.x == last.x && p.y >= last.y)) return false;
+        }
+        
+        // 超出已知范围时扩大包围盒，必要时提升计算精度
+        if (p.x < engine->box.min_x) engine->box.min_x = p.x;
+        if (p.x > engine->box.max_x) engine->box.max_x = p.x;
+        if (p.y < engine->box.min_y) engine->box.min_y = p.y;
+        if (p.y > engine->box.max_y) engine->box.max_y = p.y;
+        Precision precision = select_precision(engine->box);
+        if (precision > engine->precision) {
+            engine->precision = precision;
+            engine->hull.precision = precision;
+        }
+        
+        if (engine->V_count >= engine->V_capacity) {
+            int old_capacity = engine->V_capacity;
+            engine->V_capacity *= 2;
+            ScratchArena *arena = engine->arena;
+            engine->V = arena_realloc(arena, engine->V, old_capacity * sizeof(Point), engine->V_capacity * sizeof(Point));
+            engine->CP = arena_realloc(arena, engine->CP, old_capacity * sizeof(Point), engine->V_capacity * sizeof(Point));
+            engine->chain = arena_realloc(arena, engine->chain, old_capacity * sizeof(Point), engine->V_capacity * sizeof(Point));
+        }
+        
+        Point *V = engine->V;
+        int V_count = engine->V_count;
+        
+        // 前三个点：直接连成三角形
+        if (V_count < 3) {
+            V[engine->V_count++] = p;
+            hull_insert(&engine->hull, p);
+            if (engine->V_count == 3) {
+                TRACE("初始化最后三个点: P%d, P%d, P%d\n", V[0].id, V[1].id, V[2].id);
+                for (int i = 0; i < 3; i++) engine_emit_edge(engine, V[i], V[(i + 1) % 3]);
+            }
+            return true;
+        }
+        
+        Point Pi = p;
+        int chain_count = 0;
+        
+        TRACE(">>> 处理点 P%d\n", Pi.id);
+        if (TRACE_TEXT_ENABLED) {
+            printf("当前V中的点 (%d个): ", V_count);
+            for (int j = 0; j < V_count; j++) printf("P%d ", V[j].id);
+            printf("\n");
+            int CP_count = 0;
+            hull_collect(&engine->hull, engine->CP, &CP_count);
+            printf("当前凸包点 (%d个): ", CP_count);
+            for (int j = 0; j < CP_count; j++) printf("P%d ", engine->CP[j].id);
+            printf("\n");
+        }
+        
+        // 可见链上的点都可见（见上面的说明），按链顺序加边
+        Point *chain = engine->chain;
+        hull_visible_chain(&engine->hull, Pi, chain, &chain_count);
+        if (TRACE_TEXT_ENABLED) printf("可见点检查: ");
+        for (int k = 0; k < chain_count; k++) {
+            engine_emit_edge(engine, Pi, chain[k]);
+            if (TRACE_TEXT_ENABLED) printf("P%d ", chain[k].id);
+            TRACE_EVENT("    可见边 P%d-P%d\n", Pi.id, chain[k].id);
+        }
+        if (TRACE_TEXT_ENABLED) printf("\n");
+        
+        V[engine->V_count++] = Pi;
+        hull_insert(&engine->hull, Pi);
+        return true;
+    }
+
+    // 引擎快照
+    // 把扫描状态（已插入的点 V、凸包上下链、边集合及其哈希槽）按原样写成一个文件，
+    // 重启时 mmap(MAP_PRIVATE) 后引擎直接指向映射中的数组，不做解析也不重建，恢复耗时与点数无关；
+    // 之后的插入写在映射的私有页上，数组按保存时的容量留了空位，超出容量时才拷到 arena 中。
+    // 文件格式：EngineSnapshotHeader，之后各数组按 64 字节对齐，偏移量记录在头中。
+    #define ENGINE_SNAPSHOT_MAGIC "VNS1"
+    #define ENGINE_SNAPSHOT_VERSION 1
+    #define ENGINE_SNAPSHOT_ALIGN 64
+
+    typedef struct {
+        char magic[4];
+        uint32_t version;
+        uint32_t byte_order;        // 0x01020304，用来拒绝字节序不同的机器写的文件
+        uint32_t header_bytes;
+        uint64_t file_bytes;
+        BoundingBox box;
+        int32_t precision;
+        int32_t V_count, V_capacity;
+        int32_t hull_count, hull_capacity, upper_count, lower_count;
+        Point lowest;
+        int32_t edge_count, edge_capacity, slot_mask;
+        uint64_t V_offset, upper_offset, lower_offset, edges_offset, slots_offset;
+    } EngineSnapshotHeader;
+
+    uint64_t snapshot_align(uint64_t offset) {
+        return (offset + ENGINE_SNAPSHOT_ALIGN - 1) & ~(uint64_t)(ENGINE_SNAPSHOT_ALIGN - 1);
+    }
+
+    // 写出 bytes 字节的 data，再补零到 total 字节
+    void snapshot_write(FILE *file, const void *data, size_t bytes, size_t total) {
+        static const char zeros[ENGINE_SNAPSHOT_ALIGN * 16];
+        fwrite(data, 1, bytes, file);
+        for (size_t rest = total - bytes; rest > 0;) {
+            size_t chunk = rest < sizeof(zeros) ? rest : sizeof(zeros);
+            fwrite(zeros, 1, chunk, file);
+            rest -= chunk;
+        }
+    }
+
+    // 把引擎当前状态写入 path；失败返回 false
+    bool engine_save(const VisibleNetworkEngine *engine, const char *path) {
+        const IncrementalHull *hull = &engine->hull;
+        const EdgeSet *edges = &engine->edges;
+        EngineSnapshotHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, ENGINE_SNAPSHOT_MAGIC, 4);
+        header.version = ENGINE_SNAPSHOT_VERSION;
+        header.byte_order = 0x01020304;
+        header.header_bytes = sizeof(header);
+        header.box = engine->box;
+        header.precision = engine->precision;
+        header.V_count = engine->V_count;
+        header.V_capacity = engine->V_capacity;
+        header.hull_count = hull->count;
+        header.hull_capacity = hull->capacity;
+        header.upper_count = hull->upper_count;
+        header.lower_count = hull->lower_count;
+        header.lowest = hull->lowest;
+        header.edge_count = edges->count;
+        header.edge_capacity = edges->capacity;
+        header.slot_mask = edges->slot_mask;
+
+        size_t V_bytes = (size_t)engine->V_capacity * sizeof(Point);
+        size_t hull_bytes = (size_t)hull->capacity * sizeof(Point);
+        size_t edge_bytes = (size_t)edges->capacity * sizeof(uint64_t);
+        size_t slot_bytes = (size_t)(edges->slot_mask + 1) * sizeof(int);
+        header.V_offset = snapshot_align(sizeof(header));
+        header.upper_offset = snapshot_align(header.V_offset + V_bytes);
+        header.lower_offset = snapshot_align(header.upper_offset + hull_bytes);
+        header.edges_offset = snapshot_align(header.lower_offset + hull_bytes);
+        header.slots_offset = snapshot_align(header.edges_offset + edge_bytes);
+        header.file_bytes = snapshot_align(header.slots_offset + slot_bytes);
+
+        FILE *file = fopen(path, "wb");
+        if (file == NULL) return false;
+        snapshot_write(file, &header, sizeof(header), header.V_offset);
+        snapshot_write(file, engine->V, engine->V_count * sizeof(Point), header.upper_offset - header.V_offset);
+        snapshot_write(file, hull->upper, hull->upper_count * sizeof(Point), header.lower_offset - header.upper_offset);
+        snapshot_write(file, hull->lower, hull->lower_count * sizeof(Point), header.edges_offset - header.lower_offset);
+        snapshot_write(file, edges->edges, edges->count * sizeof(uint64_t), header.slots_offset - header.edges_offset);
+        snapshot_write(file, edges->slots, slot_bytes, header.file_bytes - header.slots_offset);
+        bool ok = !ferror(file);
+        if (fclose(file) != 0) ok = false;
+        return ok;
+    }
+
+    // 检查快照头与文件大小是否一致
+    bool snapshot_header_valid(const EngineSnapshotHeader *header, size_t file_bytes) {
+        if (file_bytes < sizeof(*header) || memcmp(header->magic, ENGINE_SNAPSHOT_MAGIC, 4) != 0 ||
+            header->version != ENGINE_SNAPSHOT_VERSION || header->byte_order != 0x01020304 ||
+            header->header_bytes != sizeof(*header) || header->file_bytes > file_bytes) {
+            return false;
+        }
+        if (header->precision < PRECISION_INT32 || header->precision > PRECISION_EXACT) return false;
+        if (header->V_count < 0 || header->V_count > header->V_capacity ||
+            header->hull_count > header->hull_capacity || header->hull_count != header->V_count ||
+            header->upper_count < 0 || header->upper_count > header->hull_count ||
+            header->lower_count < 0 || header->lower_count > header->hull_count ||
+            header->edge_count < 0 || header->edge_count > header->edge_capacity ||
+            header->slot_mask < 0 || (header->slot_mask & (header->slot_mask + 1)) != 0) {
+            return false;
+        }
+        return header->V_offset + (uint64_t)header->V_capacity * sizeof(Point) <= header->upper_offset &&
+               header->upper_offset + (uint64_t)header->hull_capacity * sizeof(Point) <= header->lower_offset &&
+               header->lower_offset + (uint64_t)header->hull_capacity * sizeof(Point) <= header->edges_offset &&
+               header->edges_offset + (uint64_t)header->edge_capacity * sizeof(uint64_t) <= header->slots_offset &&
+               header->slots_offset + (uint64_t)(header->slot_mask + 1) * sizeof(int) <= header->file_bytes;
+    }
+
+    // 从 path 的快照恢复引擎，之后可以继续 engine_insert；其余参数同 engine_init。
+    // 文件不存在、版本不符或内容不一致时返回 false，engine 不需要释放
+    bool engine_restore(VisibleNetworkEngine *engine, const char *path,
+                        EdgeCallback on_edge, void *context, ScratchArena *arena) {
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(EngineSnapshotHeader)) {
+            close(fd);
+            return false;
+        }
+        size_t file_bytes = info.st_size;
+        char *base = mmap(NULL, file_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) return false;
+        const EngineSnapshotHeader *header = (const EngineSnapshotHeader *)base;
+        if (!snapshot_header_valid(header, file_bytes)) {
+            munmap(base, file_bytes);
+            return false;
+        }
+
+        int capacity = header->V_capacity < 4 ? 4 : header->V_capacity;
+        engine->owns_arena = arena == NULL;
+        if (engine->owns_arena) {
+            arena_init(&engine->own_arena, 3 * (size_t)capacity * sizeof(Point) + 16 * ARENA_ALIGN);
+            arena = &engine->own_arena;
+        }
+        engine->arena = arena;
+        engine->snapshot = base;
+        engine->snapshot_bytes = file_bytes;
+        engine->box = header->box;
+        engine->precision = (Precision)header->precision;
+        engine->V = (Point *)(base + header->V_offset);
+        engine->V_count = header->V_count;
+        engine->V_capacity = header->V_capacity;
+
+        IncrementalHull *hull = &engine->hull;
+        hull->upper = (Point *)(base + header->upper_offset);
+        hull->lower = (Point *)(base + header->lower_offset);
+        hull->upper_count = header->upper_count;
+        hull->lower_count = header->lower_count;
+        hull->count = header->hull_count;
+        hull->capacity = header->hull_capacity;
+        hull->lowest = header->lowest;
+        hull->precision = engine->precision;
+        hull->arena = arena;
+
+        EdgeSet *edges = &engine->edges;
+        edges->edges = (uint64_t *)(base + header->edges_offset);
+        edges->slots = (int *)(base + header->slots_offset);
+        edges->count = header->edge_count;
+        edges->capacity = header->edge_capacity;
+        edges->slot_mask = header->slot_mask;
+        edges->mapped = true;
+
+        engine->CP = arena_alloc(arena, capacity * sizeof(Point));
+        engine->chain = arena_alloc(arena, capacity * sizeof(Point));
+        engine->on_edge = on_edge;
+        engine->context = context;
+
+        return true;
+    }
+
+    // 主算法：对整批点排序、按 x 递增重新编号 1..n，再从右向左依次插入引擎（单线程，
+    // 需要并行时用下面的 build_visible_network_slabs）。
+    // 结果写入 E，由调用者 edge_set_free；arena 可为 NULL，多批复用同一个 arena 时在批与批之间 arena_reset
+    void build_visible_network_arena(Point *points, int n, EdgeSet *E, ScratchArena *arena) {
+        qsort(points, n, sizeof(Point), compare_points);
+        for (int i = 0; i < n; i++) points[i].id = i + 1;
+        
+        VisibleNetworkEngine engine;
+        engine_init(&engine, bounding_box(points, n), n, NULL, NULL, arena);
+        for (int i = n - 1; i >= 0; i--) engine_insert(&engine, points[i]);
+        engine_take_edges(&engine, E);
+        engine_free(&engine);
+    }
+
+    void build_visible_network(Point *points, int n, EdgeSet *E) {
+        build_visible_network_arena(points, n, E, NULL);
+    }
+
+    // 分片并行构建
+    // Pi 加的边恰好是它到"右侧全部点的凸包"的可见链（见流式引擎的说明），与其余边无关。
+    // 因此把排好序的点按 x 切成连续的片，每片只要知道它右侧所有片的凸包，就能独立算出自己的点加的边：
+    //   1. 并行：各片单独建凸包
+    //   2. 串行：从右向左把各片的凸包点并入，得到每片右侧的凸包（只涉及凸包点，代价很小）
+    //   3. 并行：各片以右侧凸包为初始状态，从右向左扫描自己的点，记录加的边
+    //   4. 按片从右到左、片内按扫描顺序合并，边集合及加入顺序与串行扫描完全相同
+    #ifndef PARALLEL_MIN_SLAB
+    #define PARALLEL_MIN_SLAB 4096  // 每片至少的点数，点数较少时分片的收益抵不过开销
+    #endif
+
+    typedef struct {
+        const Point *points;    // 全部 n 个点，按 x 递增；本片为 points[begin, end)
+        int n;
+        int begin;
+        int end;
+        Precision precision;
+        IncrementalHull hull;           // 第 1 步：本片的凸包；第 3 步：扫描中的凸包
+        const IncrementalHull *seed;    // 本片右侧所有点的凸包，最右一片为 NULL
+        int *edge_ids;                  // 本片加的边，每条两个 id，按加入顺序
+        int edge_count;
+        int edge_capacity;
+        ScratchArena arena;             // 各片独占，线程间不共享
+    } NetworkSlab;
+
+    // 与下一个点重合的点在扫描中被引擎拒绝，不参与计算
+    bool slab_skip_point(const NetworkSlab *slab, int i) {
+        return i + 1 < slab->n && slab->points[i].x == slab->points[i + 1].x &&
+               slab->points[i].y == slab->points[i + 1].y;
+    }
+
+    void *slab_hull_main(void *arg) {
+        NetworkSlab *slab = arg;
+        hull_init(&slab->hull, slab->end - slab->begin, slab->precision, &slab->arena);
+        for (int i = slab->end - 1; i >= slab->begin; i--) {
+            if (!slab_skip_point(slab, i)) hull_insert(&slab->hull, slab->points[i]);
+        }
+        return NULL;
+    }
+
+    void slab_add_edge(NetworkSlab *slab, Point a, Point b) {
+        if (slab->edge_count >= slab->edge_capacity) {
+            size_t old_bytes = 2 * (size_t)slab->edge_capacity * sizeof(int);
+            slab->edge_capacity *= 2;
+            slab->edge_ids = arena_realloc(&slab->arena, slab->edge_ids, old_bytes,
+                                           2 * (size_t)slab->edge_capacity * sizeof(int));
+        }
+        slab->edge_ids[2 * slab->edge_count] = a.id;
+        slab->edge_ids[2 * slab->edge_count + 1] = b.id;
+        slab->edge_count++;
+    }
+
+    void *slab_network_main(void *arg) {
+        NetworkSlab *slab = arg;
+        int size = slab->end - slab->begin;
+        int capacity = size + (slab->seed != NULL ? slab->seed->count : 0);
+        IncrementalHull *hull = &slab->hull;
+        if (slab->seed != NULL) hull_clone(hull, slab->seed, capacity, &slab->arena);
+        else hull_init(hull, capacity, slab->precision, &slab->arena);
+        Point *chain = arena_alloc(&slab->arena, (capacity < 4 ? 4 : capacity) * sizeof(Point));
+        slab->edge_capacity = 3 * size + 4;
+        slab->edge_ids = arena_alloc(&slab->arena, 2 * (size_t)slab->edge_capacity * sizeof(int));
+        slab->edge_count = 0;
+        // 右侧不足三个点（全是重合点时）也要按引擎的方式连三角形；此时它们都在上链上，按扫描顺序排列
+        Point V[3];
+        for (int k = 0; k < hull->count && k < 3; k++) V[k] = hull->upper[k];
+
+        for (int i = slab->end - 1; i >= slab->begin; i--) {
+            if (slab_skip_point(slab, i)) continue;
+            Point Pi = slab->points[i];
+            if (hull->count < 3) {
+                // 最右的三个点：连成三角形
+                hull_insert(hull, Pi);
+                V[hull->count - 1] = Pi;
+                if (hull->count == 3) {
+                    for (int k = 0; k < 3; k++) slab_add_edge(slab, V[k], V[(k + 1) % 3]);
+                }
+                continue;
+            }
+            int chain_count = 0;
+            hull_visible_chain(hull, Pi, chain, &chain_count);
+            for (int k = 0; k < chain_count; k++) slab_add_edge(slab, Pi, chain[k]);
+            hull_insert(hull, Pi);
+        }
+        return NULL;
+    }
+
+    // 把 hull 上的点（上、下链的并集）按扫描顺序插入 target
+    void hull_merge_into(IncrementalHull *target, const IncrementalHull *hull) {
+        int u = 0, l = 0;
+        while (u < hull->upper_count || l < hull->lower_count) {
+            Point p;
+            if (l >= hull->lower_count) p = hull->upper[u++];
+            else if (u >= hull->upper_count) p = hull->lower[l++];
+            else {
+                int order = compare_points(&hull->upper[u], &hull->lower[l]);
+                if (order == 0) { p = hull->upper[u++]; l++; }
+                else if (order > 0) p = hull->upper[u++];
+                else p = hull->lower[l++];
+            }
+            hull_insert(target, p);
+        }
+    }
+
+    // 与 build_visible_network 结果相同，分成至多 slab_count 片并行计算；
+    // 每片不足 PARALLEL_MIN_SLAB 个点时减少片数，只剩一片时退回串行扫描
+    void build_visible_network_slabs(Point *points, int n, EdgeSet *E, int slab_count) {
+        int min_slab = PARALLEL_MIN_SLAB < 3 ? 3 : PARALLEL_MIN_SLAB;
+        if (slab_count > n / min_slab) slab_count = n / min_slab;
+        if (slab_count <= 1) {
+            build_visible_network(points, n, E);
+            return;
+        }
+        qsort(points, n, sizeof(Point), compare_points);
+        for (int i = 0; i < n; i++) points[i].id = i + 1;
+        Precision precision = select_precision(bounding_box(points, n));
+
+        NetworkSlab *slabs = malloc(slab_count * sizeof(NetworkSlab));
+        pthread_t *threads = malloc(slab_count * sizeof(pthread_t));
+        for (int s = 0; s < slab_count; s++) {
+            NetworkSlab *slab = &slabs[s];
+            slab->points = points;
+            slab->n = n;
+            slab->begin = (int)((int64_t)n * s / slab_count);
+            slab->end = (int)((int64_t)n * (s + 1) / slab_count);
+            slab->precision = precision;
+            slab->seed = NULL;
+            arena_init(&slab->arena, 8 * (size_t)(slab->end - slab->begin) * sizeof(Point));
+        }
+
+        // 1. 各片的凸包（最左一片的凸包用不到）
+        for (int s = 1; s < slab_count; s++) pthread_create(&threads[s], NULL, slab_hull_main, &slabs[s]);
+        for (int s = 1; s < slab_count; s++) pthread_join(threads[s], NULL);
+
+        // 2. 第 s 片的初始凸包 = 第 s+1 .. slab_count-1 片的全部点的凸包
+        ScratchArena seed_arena;
+        arena_init(&seed_arena, 4 * (size_t)n * sizeof(Point) / slab_count);
+        IncrementalHull *seeds = arena_alloc(&seed_arena, slab_count * sizeof(IncrementalHull));
+        IncrementalHull running;
+        hull_init(&running, 64, precision, &seed_arena);
+        for (int s = slab_count - 1; s >= 1; s--) {
+            hull_merge_into(&running, &slabs[s].hull);
+            hull_clone(&seeds[s - 1], &running, running.count, &seed_arena);
+            slabs[s - 1].seed = &seeds[s - 1];
+        }
+
+        // 3. 各片独立扫描自己的点
+        for (int s = 0; s < slab_count; s++) pthread_create(&threads[s], NULL, slab_network_main, &slabs[s]);
+        for (int s = 0; s < slab_count; s++) pthread_join(threads[s], NULL);
+
+        // 4. 按扫描顺序合并
+        edge_set_init(E, 3 * n);
+        for (int s = slab_count - 1; s >= 0; s--) {
+            for (int e = 0; e < slabs[s].edge_count; e++) {
+                edge_set_add(E, slabs[s].edge_ids[2 * e], slabs[s].edge_ids[2 * e + 1]);
+            }
+            arena_free(&slabs[s].arena);
+        }
+        arena_free(&seed_arena);
+        free(slabs);
+        free(threads);
+    }
+
+    // 测试函数
+    int main() {
+        Point points[] = {
+            {1, 4}, {2, 2}, {3, 3}, {3, 4}, {4, 2}, 
+            {5, 4}, {6, 2}, {6, 3}, {6, 5}, {7, 1}
+        };
+        int n = sizeof(points) / sizeof(points[0]);
+        
+        printf("输入点集 (%d 个点):\n", n);
+        for (int i = 0; i < n; i++) {
+            printf("P%d: (%d, %d)\n", i + 1, points[i].x, points[i].y);
+        }
+        printf("\n");
+        
+        ScratchArena arena;
+        arena_init(&arena, visible_network_scratch_bytes(n));
+        EdgeSet network_edges;
+        build_visible_network_arena(points, n, &network_edges, &arena);
+        printf("\n临时内存峰值: %zu 字节 (预分配 %zu 字节)\n",
+            arena_high_water(&arena), visible_network_scratch_bytes(n));
+        int total_edges = network_edges.count;
+        
+        printf("\n最终可见网络的所有边 (%d 条):\n", total_edges);
+        for (int i = 0; i < total_edges; i++) {
+            printf("边 %2d: P%d-P%d\n", i + 1,
+                edge_first(network_edges.edges[i]), edge_second(network_edges.edges[i]));
+        }
+        
+        // 检查预期的23条边
+        printf("\n检查预期边:\n");
+        int expected_edges[23][2] = {
+            {8,9}, {9,10}, {8,10}, {7,8}, {7,10}, {6,7}, {6,8}, {6,9},
+            {5,6}, {5,7}, {5,10}, {4,5}, {4,6}, {4,9}, {3,4}, {3,5},
+            {2,3}, {2,4}, {2,5}, {2,10}, {1,2}, {1,4}, {1,9}
+        };
+        
+        int missing_count = 0;
+        int extra_count = 0;
+        
+        for (int i = 0; i < 23; i++) {
+            int id1 = expected_edges[i][0];
+            int id2 = expected_edges[i][1];
+            if (!edge_set_contains(&network_edges, id1, id2)) {
+                printf("缺少边: P%d-P%d\n", id1, id2);
+                missing_count++;
+            }
+        }
+        
+        // 检查多余的边
+        printf("\n检查多余边:\n");
+        for (int i = 0; i < total_edges; i++) {
+            int id1 = edge_first(network_edges.edges[i]);
+            int id2 = edge_second(network_edges.edges[i]);
+            bool found = false;
+            for (int j = 0; j < 23; j++) {
+                if ((id1 == expected_edges[j][0] && id2 == expected_edges[j][1]) ||
+                    (id1 == expected_edges[j][1] && id2 == expected_edges[j][0])) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                printf("多余边: P%d-P%d\n", id1, id2);
+                extra_count++;
+            }
+        }
+        
+        if (missing_count == 0 && extra_count == 0) {
+            printf("✓ 所有预期边都存在，没有多余边！\n");
+        } else {
+            printf("✗ 缺少 %d 条边，多出 %d 条边\n", missing_count, extra_count);
+        }
+        
+        edge_set_free(&network_edges);
+        arena_free(&arena);
+        TRACE_DUMP("algorithm1.trace");
+        return 0;
     }
\ No newline at end of file
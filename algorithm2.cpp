@@ -1,246 +1,1627 @@
-#include <iostream>
-#include <vector>
-#include <map>
-#include <set>
-#include <string>
-#include <sstream>
-#include <algorithm> 
-#include <queue>     
-
-// --- 辅助函数 ---
-
-/**
- * @brief 打印一个集合 (set) 的内容，用于中间过程
- */
-void print_set(const std::set<int>& s) {
-    std::cout << "{";
-    bool first = true;
-    for (int id : s) {
-        if (!first) {
-            std::cout << ", ";
-        }
-        std::cout << "P" << id;
-        first = false;
-    }
-    std::cout << "}";
-}
-
-/**
- * @brief 检查 C_t 是否是 L_i^l 的子集
- */
-bool is_ct_subset_li(const std::set<int>& Ct, const std::set<int>& Li) {
-    // 检查 Ct 中的每个元素是否都存在于 Li 中
-    return std::all_of(Ct.begin(), Ct.end(), [&](int Pk_id) {
-        return Li.count(Pk_id) > 0;
-    });
-}
-
-/**
- * @brief 计算 L_i^l (P_i 的 l-层 邻居)
- * * 根据伪代码和PPT的扫描逻辑 (从右到左), L_i^l 似乎是指
- * 所有在 P_i "右侧" (即 ID > i) 且在 l 跳 (hops) 内可达的事务。
- *
- * @param Pi_id   当前扫描的事务 ID
- * @param l_val   l-层 (l=1 表示直接邻居, l=2 表示邻居的邻居, 等)
- * @param n       总事务数 (未使用, 但可用于边界)
- * @param adj     完整的邻接表 (图 G_vis)
- * @return std::set<int> L_i^l 集合
- */
-std::set<int> calculate_Li_l(int Pi_id, int l_val, int n, const std::map<int, std::set<int>>& adj) {
-    std::set<int> Li_l_set;
-    if (l_val <= 0) {
-        return Li_l_set;
-    }
-
-    std::queue<std::pair<int, int>> q; // {node_id, distance}
-    q.push({Pi_id, 0});
-    
-    std::map<int, int> distance; // 存储从 Pi_id 出发的距离
-    distance[Pi_id] = 0;
-
-    while (!q.empty()) {
-        std::pair<int, int> current = q.front();
-        q.pop();
-        int current_id = current.first;
-        int current_dist = current.second;
-
-        // 如果距离超过 l_val，停止这条路径的搜索
-        if (current_dist >= l_val) {
-            continue;
-        }
-
-        // 遍历所有邻居
-        if (adj.count(current_id)) {
-            for (int neighbor_id : adj.at(current_id)) {
-                // 如果这个邻居还没有被访问过
-                if (distance.find(neighbor_id) == distance.end()) {
-                    int new_dist = current_dist + 1;
-                    distance[neighbor_id] = new_dist;
-                    
-                    // 关键约束：只添加 ID > Pi_id 的事务
-                    if (neighbor_id > Pi_id) {
-                        Li_l_set.insert(neighbor_id);
-                    }
-                    
-                    // 继续搜索 (即使 neighbor_id <= Pi_id，它仍然可以作为桥梁)
-                    q.push({neighbor_id, new_dist});
-                }
-            }
-        }
-    }
-
-    return Li_l_set;
-}
-
-
-// --- 算法输入数据 ---
-
-/**
- * @brief 步骤 0: 设置算法1的输出 (来自 image_67435b.png 和 algorithm1.c)
- * @return 包含23条边的邻接表
- */
-std::map<int, std::set<int>> setupAdjacencyList_Edges() {
-    std::map<int, std::set<int>> adj;
-    
-    // 初始化所有10个点
-    for (int i = 1; i <= 10; ++i) {
-        adj[i] = {};
-    }
-
-    // 23条边的列表 
-    std::vector<std::pair<int, int>> edges = {
-        {8, 9}, {9, 10}, {8, 10},
-        {7, 8}, {7, 10},
-        {6, 7}, {6, 8}, {6, 9},
-        {5, 6}, {5, 7}, {5, 10},
-        {3, 4}, {3, 5},
-        {4, 5}, {4, 6}, {4, 9},
-        {2, 3}, {2, 4}, {2, 5}, {2, 10},
-        {1, 2}, {1, 4}, {1, 9}
-    };
-
-    // 构建邻接表
-    for (const auto& edge : edges) {
-        adj[edge.first].insert(edge.second);
-        adj[edge.second].insert(edge.first);
-    }
-    
-    return adj;
-}
-
-// --- 主函数 ---
-
-int main() {
-    // --- 步骤 0: 初始化参数 (l, k 可修改) ---
-    // =============================================
-    // =          在这里修改 l 和 k 的值          =
-    // =============================================
-    int k = 3;  // 目标簇大小 (例如: 3)
-    int l = 1;  // 邻接层数 (例如: 1)
-    // =============================================
-
-    const int n = 10; // 总事务数
-
-    std::cout << "--- 算法2: 交易打包选择算法  ---" << std::endl;
-    std::cout << "参数: K = " << k << ", L = " << l << std::endl;
-    std::cout << "输入: 算法1提供的 23 条可见边 " << std::endl;
-
-    // 获取算法1的输出 (G_vis)
-    std::map<int, std::set<int>> adj = setupAdjacencyList_Edges();
-
-    // H 是一个数组，索引代表簇的大小 j
-    // H[j] 是一个 vector，包含所有大小为 j 的簇 (set)
-    std::vector<std::set<int>> H[k + 1];
-
-    // --- 算法2 伪代码 第1行: 初始化 H_1 ---
-    std::cout << "\n--- 1. 初始化 H_1 (j=1) ---" << std::endl;
-    for (int i = 1; i <= n; ++i) {
-        H[1].push_back({i});
-    }
-    std::cout << "H_1 (共 " << H[1].size() << " 个簇): {";
-    for (size_t i = 0; i < H[1].size(); ++i) {
-        print_set(H[1][i]);
-        if (i < H[1].size() - 1) std::cout << ", ";
-    }
-    std::cout << "}" << std::endl;
-
-    // --- 算法2 伪代码 第3-11行: 迭代构建 H_j ---
-    for (int j = 2; j <= k; ++j) {
-        std::cout << "\n--- 2. 开始构建 H_" << j << " (j=" << j << ") ---" << std::endl;
-        
-        // 第4行: for i = n-j+1; i >= 1; i--
-        for (int i = n - j + 1; i >= 1; --i) {
-            int Pi_id = i;
-            
-            // 计算 L_i^l (P_i 的 l-层 "右侧" 邻居)
-            const std::set<int> Li = calculate_Li_l(Pi_id, l, n, adj);
-            
-            std::cout << "\n   扫描 P_i = P" << Pi_id << ":" << std::endl;
-            std::cout << "      L_" << Pi_id << "^" << l << " (l=" << l << " 跳可达且 ID > " << Pi_id << "): ";
-            print_set(Li);
-            std::cout << std::endl;
-
-            // 第5行: for each C_t in H_{j-1}
-            for (const auto& Ct : H[j - 1]) {
-                
-                // 优化：只检查那些在 P_i "右侧" (ID更大) 的簇
-                bool all_gt_i = true;
-                for (int id : Ct) {
-                    if (id <= Pi_id) {
-                        all_gt_i = false;
-                        break;
-                    }
-                }
-                
-                if (!all_gt_i) {
-                    continue; // 跳过 C_t = {P_m, ...} m <= i 的情况
-                }
-
-                std::cout << "      - 检查 H_" << (j - 1) << " 中的 C_t = ";
-                print_set(Ct);
-                std::cout << std::endl;
-
-                // 第6行: if C_t subset L_i^l
-                if (is_ct_subset_li(Ct, Li)) {
-                    // 第7行: H_j <- H_j U {P_i, C_t}
-                    std::set<int> newCluster = Ct;
-                    newCluster.insert(Pi_id);
-                    H[j].push_back(newCluster);
-                    
-                    std::cout << "         -> OK! C_t 是 L_" << Pi_id << "^" << l << " 的子集。" << std::endl;
-                    std::cout << "         -> 创建新 H_" << j << " 簇: ";
-                    print_set(newCluster);
-                    std::cout << std::endl;
-                } else {
-                    std::cout << "         -> 失败! C_t 不是 L_" << Pi_id << "^" << l << " 的子集。" << std::endl;
-                }
-            }
-        }
-        
-        std::cout << "\n--- H_" << j << " 构建完成 (共 " << H[j].size() << " 个簇) ---" << std::endl;
-        // 打印所有 H_j 的内容
-        for (size_t i = 0; i < H[j].size(); ++i) {
-            print_set(H[j][i]);
-            if ((i + 1) % 5 == 0) std::cout << std::endl; // 每5个换行
-            else if (i < H[j].size() - 1) std::cout << ", ";
-        }
-        std::cout << std::endl;
-    }
-
-    std::cout << "\n--- 算法2 执行完成 (j=" << k << ") ---" << std::endl;
-
-    // --- 算法2 伪代码 第12-17行: 查找最佳 H_k ---
-    // 伪代码的这一部分需要 R(C_t) (评分函数)，
-    // 该函数需要 w_j (等待时间), e_j (事务优先级), a_j (设备优先级)
-    // 这些数据在 algorithm1.c 中未定义。
-    // 因此，我们仅打印出 H_k (即 H_3) 的所有候选簇，这与 PPT 第6页的演示一致。
-    
-    std::cout << "\n--- 最终 H_" << k << " 候选簇列表 (共 " << H[k].size() << " 个) ---" << std::endl;
-    for (size_t i = 0; i < H[k].size(); ++i) {
-        std::cout << "   候选 " << (i + 1) << ": ";
-        print_set(H[k][i]);
-        std::cout << std::endl;
-    }
-
-    return 0;
+#include <iostream>
+#include <vector>
+#include <map>
+#include <set>
+#include <string>
+#include <sstream>
+#include <algorithm> 
+#include <queue>     
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include "trace.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// --- 辅助函数 ---
+
+/**
+ * @brief 打印一个簇（升序 id 数组）的内容，用于中间过程
+ */
+void print_cluster(const int32_t* ids, int width) {
+    std::cout << "{";
+    for (int m = 0; m < width; ++m) {
+        if (m > 0) {
+            std::cout << ", ";
+        }
+        std::cout << "P" << ids[m];
+    }
+    std::cout << "}";
+}
+
+/**
+ * @brief 同一层 H_j 的所有簇：每个簇是 j 个升序 id，按加入顺序平铺在一块连续内存中，
+ *        不再为每个簇单独分配一棵 std::set。
+ *        id 数组可以是自有的 std::vector，也可以是只读映射（快照）中的一段，见 mapped()；
+ *        映射中的层第一次被修改时才拷贝成自有数组。
+ */
+class ClusterLevel {
+public:
+    explicit ClusterLevel(int width = 0) : width_(width) {}
+
+    /**
+     * @brief 直接引用 mapping 中从 ids 开始的 count 个 id，不拷贝；mapping 在最后一个引用它的层释放后解除映射
+     */
+    static ClusterLevel mapped(int width, const std::shared_ptr<const void>& mapping, const int32_t* ids, size_t count) {
+        ClusterLevel level(width);
+        level.view_ = std::shared_ptr<const int32_t>(mapping, ids);
+        level.view_count_ = count;
+        return level;
+    }
+
+    int width() const { return width_; }
+    size_t size() const { return width_ == 0 ? 0 : id_count() / width_; }
+    const int32_t* operator[](size_t c) const { return data() + c * width_; }
+
+    /** @brief 所有簇的 id，按簇顺序平铺，共 size() * width() 个 */
+    const int32_t* data() const { return view_ ? view_.get() : ids_.data(); }
+    size_t id_count() const { return view_ ? view_count_ : ids_.size(); }
+
+    /** @brief 可修改的 id 数组；引用映射时先拷贝出来 */
+    std::vector<int32_t>& ids() {
+        if (view_) {
+            ids_.assign(view_.get(), view_.get() + view_count_);
+            view_.reset();
+            view_count_ = 0;
+        }
+        return ids_;
+    }
+
+    void add(std::initializer_list<int32_t> cluster) {
+        std::vector<int32_t>& all = ids();
+        all.insert(all.end(), cluster);
+    }
+
+    /** @brief 加入簇 {first} ∪ rest，first 小于 rest 中所有 id */
+    void add_extended(int32_t first, const int32_t* rest) {
+        ids().push_back(first);
+        ids_.insert(ids_.end(), rest, rest + width_ - 1);
+    }
+
+private:
+    int width_;
+    std::vector<int32_t> ids_;
+    std::shared_ptr<const int32_t> view_;   // 非空时 id 在映射中，ids_ 不用
+    size_t view_count_ = 0;
+};
+
+/**
+ * @brief 稠密位集的只读视图，第 id 位表示事务 P_id
+ */
+struct BitRow {
+    const uint64_t* words;
+    int word_count;
+
+    bool test(int id) const {
+        return (words[id >> 6] >> (id & 63)) & 1;
+    }
+
+    int count() const {
+        int total = 0;
+        for (int w = 0; w < word_count; ++w) total += __builtin_popcountll(words[w]);
+        return total;
+    }
+};
+
+/**
+ * @brief 打印位集中的事务，格式同 print_set
+ */
+void print_bits(BitRow row) {
+    std::cout << "{";
+    bool first = true;
+    for (int w = 0; w < row.word_count; ++w) {
+        for (uint64_t bits = row.words[w]; bits != 0; bits &= bits - 1) {
+            if (!first) {
+                std::cout << ", ";
+            }
+            std::cout << "P" << (w * 64 + __builtin_ctzll(bits));
+            first = false;
+        }
+    }
+    std::cout << "}";
+}
+
+/**
+ * @brief 检查 C_t 是否是 L_i^l 的子集：对每个成员所在的字做 (C & ~L) == 0。
+ *        只用于文本跟踪时逐个簇打印检查过程；构建时由 ClusterIndex 沿 L_i^l 的分支直接取出子集。
+ */
+bool is_ct_subset_li(const int32_t* Ct, int width, BitRow Li) {
+    for (int m = 0; m < width; ++m) {
+        uint64_t member = uint64_t(1) << (Ct[m] & 63);
+        if ((member & ~Li.words[Ct[m] >> 6]) != 0) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 交易池的一次变化：进入和离开的事务、新增和删除的可见边。
+ *        应用顺序为 删边 -> 删点（连同它的所有边）-> 加点 -> 加边；端点不在池中的边被忽略。
+ */
+struct GraphDelta {
+    std::vector<int> added_nodes;
+    std::vector<int> removed_nodes;
+    std::vector<std::pair<int, int>> added_edges;
+    std::vector<std::pair<int, int>> removed_edges;
+};
+
+/**
+ * @brief L_i^l 的索引：所有在 P_i "右侧" (即 ID > i) 且在 l 跳 (hops) 内可达的事务。
+ *
+ * 根据伪代码和PPT的扫描逻辑 (从右到左) 定义 L_i^l；l 跳以内的路径可以经过 ID <= i 的事务作为桥梁。
+ * 每个 l 只对所有事务计算一次，之后每一层 j、以及参数扫描中重复用到的 l 都直接返回缓存的位集。
+ * 以所有事务为起点同时做逐层扩展：ball 记录各点 d 跳以内可达的集合，frontier 记录恰好 d 跳的集合，
+ * 下一层 = frontier 中每个点的邻接位集按字 OR 起来；请求更大的 l 时从已算到的半径继续扩展。
+ * 交易池变化时用 apply_delta 只重算可能受影响的行（见 apply_delta）。
+ */
+class NeighborhoodIndex {
+public:
+    /**
+     * @brief 被 apply_delta 改变了的 L_i^l 行
+     */
+    struct RowChanges {
+        std::vector<int> ids;
+        std::vector<uint64_t> old_rows;     // 与 ids 对应的旧行，按行平铺
+    };
+
+    /**
+     * @param adj 完整的邻接表 (图 G_vis)，出现在其中的 ID 即池中的事务
+     * @param n   最大事务 ID，事务 ID 为 1..n
+     */
+    NeighborhoodIndex(const std::map<int, std::set<int>>& adj, int n)
+        : n_(n), word_count_((n + 1 + 63) / 64),
+          adjacency_((n + 1) * word_count_, 0), present_(word_count_, 0) {
+        for (const auto& entry : adj) {
+            if (entry.first >= 1 && entry.first <= n) set_bit(present_.data(), entry.first);
+            for (int neighbor : entry.second) {
+                if (entry.first >= 1 && entry.first <= n && neighbor >= 1 && neighbor <= n) {
+                    set_bit(&adjacency_[entry.first * word_count_], neighbor);
+                }
+            }
+        }
+        previous_present_ = present_;
+        reset_ball();
+    }
+
+    /** @brief 当前最大事务 ID */
+    int size() const { return n_; }
+
+    /** @brief 每行的字数（可能大于 (size() + 64) / 64，多出的字为 0） */
+    int word_count() const { return word_count_; }
+
+    /** @brief P_id 当前是否在池中 */
+    bool present(int id) const {
+        return id >= 1 && id <= n_ && ((present_[id >> 6] >> (id & 63)) & 1);
+    }
+
+    /** @brief 最近一次 apply_delta 之前 P_id 是否在池中 */
+    bool was_present(int id) const {
+        return id >= 1 && id <= n_ && ((previous_present_[id >> 6] >> (id & 63)) & 1);
+    }
+
+    /**
+     * @brief 返回 L_i^l；l <= 0 时为空集
+     */
+    BitRow right_neighbors(int i, int l) {
+        prepare(l);
+        return prepared_row(i, l);
+    }
+
+    /**
+     * @brief 计算并缓存所有 L_i^l
+     */
+    void prepare(int l) {
+        if (right_.find(l) == right_.end()) right_.emplace(l, compute_right(l));
+    }
+
+    /**
+     * @brief 只读取已 prepare(l) 的结果，可在多个线程中并发调用
+     */
+    BitRow prepared_row(int i, int l) const {
+        return BitRow{&right_.at(l)[i * word_count_], word_count_};
+    }
+
+    /**
+     * @brief 最近一次 apply_delta 之前的 L_i^l（调用 apply_delta 时 l 必须已 prepare）
+     */
+    BitRow previous_row(int i, int l) const {
+        auto found = changes_.find(l);
+        if (found != changes_.end()) {
+            const RowChanges& changes = found->second;
+            auto at = std::lower_bound(changes.ids.begin(), changes.ids.end(), i);
+            if (at != changes.ids.end() && *at == i) {
+                return BitRow{&changes.old_rows[(at - changes.ids.begin()) * word_count_], word_count_};
+            }
+        }
+        return prepared_row(i, l);
+    }
+
+    /**
+     * @brief 最近一次 apply_delta 改变了的 L_i^l 行，ids 升序
+     */
+    const RowChanges& last_changes(int l) const {
+        static const RowChanges none;
+        auto found = changes_.find(l);
+        return found == changes_.end() ? none : found->second;
+    }
+
+    /**
+     * @brief 建立（或在图变化后重建）每个事务 ID 更大的邻居的升序数组，即 L_i^1 的压缩形式
+     */
+    void prepare_forward() {
+        if (forward_valid_) return;
+        forward_offsets_.assign(n_ + 2, 0);
+        forward_ids_.clear();
+        std::vector<uint64_t> row(word_count_);
+        for (int i = 1; i <= n_; ++i) {
+            forward_offsets_[i] = static_cast<uint32_t>(forward_ids_.size());
+            keep_right(&adjacency_[i * word_count_], i, row.data());
+            for (int w = 0; w < word_count_; ++w) {
+                for (uint64_t bits = row[w]; bits != 0; bits &= bits - 1) forward_ids_.push_back(w * 64 + __builtin_ctzll(bits));
+            }
+        }
+        forward_offsets_[n_ + 1] = static_cast<uint32_t>(forward_ids_.size());
+        forward_valid_ = true;
+    }
+
+    /** @brief P_i 的 ID 更大的邻居 [begin, end)，升序；需先 prepare_forward() */
+    const int32_t* forward_begin(int i) const { return forward_ids_.data() + forward_offsets_[i]; }
+    const int32_t* forward_end(int i) const { return forward_ids_.data() + forward_offsets_[i + 1]; }
+
+    /**
+     * @brief 在当前图（previous 为 true 时为最近一次 apply_delta 之前的图）中，
+     *        与 seeds 中某个事务相距不超过 hops 跳的所有事务（含 seeds 自身）
+     */
+    std::vector<uint64_t> reach(const std::vector<uint64_t>& seeds, int hops, bool previous) const {
+        std::vector<uint64_t> ball(seeds), frontier(seeds), next(word_count_);
+        for (int h = 0; h < hops; ++h) {
+            std::fill(next.begin(), next.end(), 0);
+            for (int w = 0; w < word_count_; ++w) {
+                for (uint64_t bits = frontier[w]; bits != 0; bits &= bits - 1) {
+                    const uint64_t* neighbors = adjacency_row(w * 64 + __builtin_ctzll(bits), previous);
+                    for (int v = 0; v < word_count_; ++v) next[v] |= neighbors[v];
+                }
+            }
+            bool grew = false;
+            for (int w = 0; w < word_count_; ++w) {
+                frontier[w] = next[w] & ~ball[w];
+                ball[w] |= frontier[w];
+                grew |= frontier[w] != 0;
+            }
+            if (!grew) break;
+        }
+        return ball;
+    }
+
+    /**
+     * @brief 把交易池的变化应用到图上，并更新所有已缓存的 L_i^l。
+     *
+     * 只有邻接行改变了的事务（变化边的端点）记为 touched。P_i 的 l 跳可达集合要改变，
+     * 新图或旧图中必有一条长度 <= l 的路径经过变化的边，且路径在第一条变化边之前的部分只用未变的边，
+     * 所以 P_i 与某个 touched 事务在旧图或新图中相距不超过 l - 1 跳。只对这些事务逐个重算 l 跳可达集合，
+     * 内容真正改变的行记入 last_changes(l)，旧行留作 previous_row。
+     */
+    void apply_delta(const GraphDelta& delta) {
+        int new_n = n_;
+        for (int id : delta.added_nodes) new_n = std::max(new_n, id);
+        grow(new_n);
+        previous_present_ = present_;
+        previous_adjacency_.clear();
+        changes_.clear();
+        std::vector<uint64_t> touched(word_count_, 0);
+
+        auto save_row = [&](int id) {
+            if (previous_adjacency_.find(id) == previous_adjacency_.end()) {
+                const uint64_t* row = &adjacency_[id * word_count_];
+                previous_adjacency_.emplace(id, std::vector<uint64_t>(row, row + word_count_));
+            }
+            set_bit(touched.data(), id);
+        };
+        auto change_edge = [&](int a, int b, bool add) {
+            if (!present(a) || !present(b) || a == b) return;
+            save_row(a);
+            save_row(b);
+            if (add) {
+                set_bit(&adjacency_[a * word_count_], b);
+                set_bit(&adjacency_[b * word_count_], a);
+            } else {
+                clear_bit(&adjacency_[a * word_count_], b);
+                clear_bit(&adjacency_[b * word_count_], a);
+            }
+        };
+
+        for (const auto& edge : delta.removed_edges) change_edge(edge.first, edge.second, false);
+        for (int id : delta.removed_nodes) {
+            if (!present(id)) continue;
+            uint64_t* row = &adjacency_[id * word_count_];
+            for (int w = 0; w < word_count_; ++w) {
+                for (uint64_t bits = row[w]; bits != 0; bits &= bits - 1) {
+                    change_edge(id, w * 64 + __builtin_ctzll(bits), false);
+                }
+            }
+            clear_bit(present_.data(), id);
+        }
+        for (int id : delta.added_nodes) {
+            if (id >= 1) set_bit(present_.data(), id);
+        }
+        for (const auto& edge : delta.added_edges) change_edge(edge.first, edge.second, true);
+
+        ball_valid_ = false;
+        forward_valid_ = false;
+        std::vector<uint64_t> ball;
+        for (auto& cached : right_) {
+            const int l = cached.first;
+            if (l <= 0) continue;
+            std::vector<uint64_t> dirty = reach(touched, l - 1, true);
+            std::vector<uint64_t> dirty_new = reach(touched, l - 1, false);
+            for (int w = 0; w < word_count_; ++w) dirty[w] |= dirty_new[w];
+
+            RowChanges& changes = changes_[l];
+            std::vector<uint64_t> row(word_count_);
+            for (int w = 0; w < word_count_; ++w) {
+                for (uint64_t bits = dirty[w]; bits != 0; bits &= bits - 1) {
+                    const int i = w * 64 + __builtin_ctzll(bits);
+                    std::vector<uint64_t> seed(word_count_, 0);
+                    set_bit(seed.data(), i);
+                    ball = reach(seed, l, false);
+                    keep_right(ball.data(), i, row.data());
+                    uint64_t* stored = &cached.second[i * word_count_];
+                    if (std::equal(row.begin(), row.end(), stored)) continue;
+                    changes.ids.push_back(i);
+                    changes.old_rows.insert(changes.old_rows.end(), stored, stored + word_count_);
+                    std::copy(row.begin(), row.end(), stored);
+                }
+            }
+        }
+    }
+
+private:
+    static void set_bit(uint64_t* row, int id) {
+        row[id >> 6] |= uint64_t(1) << (id & 63);
+    }
+
+    static void clear_bit(uint64_t* row, int id) {
+        row[id >> 6] &= ~(uint64_t(1) << (id & 63));
+    }
+
+    // row = ball ∩ {ID > i}
+    void keep_right(const uint64_t* ball, int i, uint64_t* row) const {
+        std::fill(row, row + word_count_, 0);
+        int first_word = (i + 1) >> 6;
+        if (first_word >= word_count_) return;
+        for (int w = first_word; w < word_count_; ++w) row[w] = ball[w];
+        // 清掉 ID <= i 的位
+        row[first_word] &= ~uint64_t(0) << ((i + 1) & 63);
+    }
+
+    const uint64_t* adjacency_row(int id, bool previous) const {
+        if (previous) {
+            auto found = previous_adjacency_.find(id);
+            if (found != previous_adjacency_.end()) return found->second.data();
+        }
+        return &adjacency_[id * word_count_];
+    }
+
+    // 最大 ID 增加到 new_n；行宽不够时按倍数加宽并重排所有按行平铺的位集
+    void grow(int new_n) {
+        if (new_n <= n_) return;
+        const int needed = (new_n + 1 + 63) / 64;
+        if (needed > word_count_) {
+            const int stride = std::max(needed, 2 * word_count_);
+            auto widen = [&](std::vector<uint64_t>& rows) {
+                const size_t count = rows.size() / word_count_;
+                std::vector<uint64_t> wider(count * stride, 0);
+                for (size_t r = 0; r < count; ++r) {
+                    std::copy(&rows[r * word_count_], &rows[r * word_count_] + word_count_, &wider[r * stride]);
+                }
+                rows.swap(wider);
+            };
+            widen(adjacency_);
+            widen(present_);
+            for (auto& cached : right_) widen(cached.second);
+            word_count_ = stride;
+        }
+        n_ = new_n;
+        adjacency_.resize((n_ + 1) * word_count_, 0);
+        for (auto& cached : right_) cached.second.resize((n_ + 1) * word_count_, 0);
+        ball_valid_ = false;
+    }
+
+    void reset_ball() {
+        ball_.assign((n_ + 1) * word_count_, 0);
+        for (int i = 1; i <= n_; ++i) set_bit(&ball_[i * word_count_], i);
+        frontier_ = ball_;
+        radius_ = 0;
+        ball_valid_ = true;
+    }
+
+    // ball_ 从当前半径扩展一跳
+    void expand() {
+        std::vector<uint64_t> next(word_count_);
+        for (int i = 1; i <= n_; ++i) {
+            uint64_t* ball = &ball_[i * word_count_];
+            uint64_t* frontier = &frontier_[i * word_count_];
+            std::fill(next.begin(), next.end(), 0);
+            for (int w = 0; w < word_count_; ++w) {
+                for (uint64_t bits = frontier[w]; bits != 0; bits &= bits - 1) {
+                    const uint64_t* neighbors = &adjacency_[(w * 64 + __builtin_ctzll(bits)) * word_count_];
+                    for (int v = 0; v < word_count_; ++v) next[v] |= neighbors[v];
+                }
+            }
+            for (int w = 0; w < word_count_; ++w) {
+                frontier[w] = next[w] & ~ball[w];
+                ball[w] |= frontier[w];
+            }
+        }
+        ++radius_;
+    }
+
+    // 对所有 i 计算 L_i^l = (l 跳以内可达) ∩ {ID > i}
+    std::vector<uint64_t> compute_right(int l) {
+        std::vector<uint64_t> right((n_ + 1) * word_count_, 0);
+        if (l <= 0) return right;
+        if (!ball_valid_ || l < radius_) reset_ball();
+        while (radius_ < l) expand();
+        for (int i = 1; i <= n_; ++i) {
+            keep_right(&ball_[i * word_count_], i, &right[i * word_count_]);
+        }
+        return right;
+    }
+
+    int n_;
+    int word_count_;
+    std::vector<uint64_t> adjacency_;   // 第 i 行：P_i 的邻居
+    std::vector<uint64_t> present_;     // 池中的事务
+    std::vector<uint64_t> ball_;        // 第 i 行：radius_ 跳以内可达（含 P_i 自身）
+    std::vector<uint64_t> frontier_;    // 第 i 行：恰好 radius_ 跳可达
+    int radius_ = 0;
+    bool ball_valid_ = false;           // 图变化后 ball_ 作废，下次 compute_right 时从头扩展
+    std::map<int, std::vector<uint64_t>> right_;    // l -> 所有 L_i^l，按行平铺
+    std::vector<uint32_t> forward_offsets_;         // L_i^1 的压缩形式：forward_ids_ 中的 [offset_i, offset_{i+1})
+    std::vector<int32_t> forward_ids_;
+    bool forward_valid_ = false;
+
+    // 最近一次 apply_delta 之前的状态，只保存改变了的部分
+    std::vector<uint64_t> previous_present_;
+    std::map<int, std::vector<uint64_t>> previous_adjacency_;  // touched 事务 -> 旧邻接行
+    std::map<int, RowChanges> changes_;
+};
+
+// --- 簇层级快照 ---
+
+/**
+ * @brief 快照文件头。之后是 levels_offset 处的 LevelEntry[k + 1]（下标 0 不用），
+ *        以及各层的簇：第 j 层共 count 个簇，每个簇 j 个升序 int32 id，连续存放在该层的 offset 处。
+ *        整个文件可以直接 mmap 读取，各层是定长记录的平铺数组，不需要解析。
+ */
+struct LevelSnapshotHeader {
+    char magic[4];          // "HLV1"
+    uint32_t version;
+    uint32_t byte_order;    // 0x01020304，拒绝字节序不同的机器写的文件
+    uint32_t header_bytes;
+    uint64_t file_bytes;
+    int32_t k;
+    int32_t l;
+    int32_t n;
+    int32_t reserved;
+    uint64_t graph_hash;    // 邻接表的指纹，图变了快照就作废
+    uint64_t levels_offset;
+};
+
+struct LevelEntry {
+    uint64_t offset;
+    uint64_t count;
+};
+
+const char LEVEL_SNAPSHOT_MAGIC[4] = {'H', 'L', 'V', '1'};
+const uint32_t LEVEL_SNAPSHOT_VERSION = 1;
+
+/**
+ * @brief 邻接表的 FNV-1a 指纹（按 id 顺序遍历所有边）
+ */
+uint64_t graph_fingerprint(const std::map<int, std::set<int>>& adj) {
+    uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&](int value) {
+        for (int b = 0; b < 4; ++b) {
+            hash ^= (static_cast<uint32_t>(value) >> (8 * b)) & 0xFF;
+            hash *= 1099511628211ULL;
+        }
+    };
+    for (const auto& entry : adj) {
+        mix(entry.first);
+        mix(static_cast<int>(entry.second.size()));
+        for (int neighbor : entry.second) mix(neighbor);
+    }
+    return hash;
+}
+
+/**
+ * @brief 把 H_1..H_k 写成快照文件
+ * @return 写入成功返回 true
+ */
+bool save_levels(const char* path, const std::vector<ClusterLevel>& H, int k, int l, int n,
+                 const std::map<int, std::set<int>>& adj) {
+    LevelSnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, LEVEL_SNAPSHOT_MAGIC, 4);
+    header.version = LEVEL_SNAPSHOT_VERSION;
+    header.byte_order = 0x01020304;
+    header.header_bytes = sizeof(header);
+    header.k = k;
+    header.l = l;
+    header.n = n;
+    header.graph_hash = graph_fingerprint(adj);
+    header.levels_offset = sizeof(header);
+
+    std::vector<LevelEntry> levels(k + 1, LevelEntry{0, 0});
+    uint64_t offset = header.levels_offset + (k + 1) * sizeof(LevelEntry);
+    for (int j = 1; j <= k; ++j) {
+        levels[j].offset = offset;
+        levels[j].count = H[j].size();
+        offset += levels[j].count * j * sizeof(int32_t);
+    }
+    header.file_bytes = offset;
+
+    FILE* file = std::fopen(path, "wb");
+    if (file == nullptr) return false;
+    std::fwrite(&header, sizeof(header), 1, file);
+    std::fwrite(levels.data(), sizeof(LevelEntry), levels.size(), file);
+    for (int j = 1; j <= k; ++j) {
+        if (H[j].id_count() > 0) std::fwrite(H[j].data(), sizeof(int32_t), H[j].id_count(), file);
+    }
+    bool ok = !std::ferror(file);
+    if (std::fclose(file) != 0) ok = false;
+    return ok;
+}
+
+/**
+ * @brief 从快照恢复 H_1..H_k。文件以只读方式 mmap，H 的各层直接引用映射中平铺的 id 数组，
+ *        不拷贝，也不再做 L_i^l 的 BFS 和子集检查；映射在 H 中最后一个引用它的层释放时解除。
+ * @return 文件不存在、版本不符、参数 (k, l, n) 或图与当前不一致时返回 false，H 不变
+ */
+bool load_levels(const char* path, std::vector<ClusterLevel>& H, int k, int l, int n,
+                 const std::map<int, std::set<int>>& adj) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(LevelSnapshotHeader)) {
+        close(fd);
+        return false;
+    }
+    size_t file_bytes = info.st_size;
+    void* address = mmap(nullptr, file_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) return false;
+    std::shared_ptr<const void> mapping(address, [file_bytes](const void* p) { munmap(const_cast<void*>(p), file_bytes); });
+    const char* base = static_cast<const char*>(address);
+    const auto* header = reinterpret_cast<const LevelSnapshotHeader*>(base);
+
+    bool ok = std::memcmp(header->magic, LEVEL_SNAPSHOT_MAGIC, 4) == 0 &&
+              header->version == LEVEL_SNAPSHOT_VERSION && header->byte_order == 0x01020304 &&
+              header->header_bytes == sizeof(LevelSnapshotHeader) && header->file_bytes <= file_bytes &&
+              header->k == k && header->l == l && header->n == n &&
+              header->graph_hash == graph_fingerprint(adj) &&
+              header->levels_offset + (k + 1) * sizeof(LevelEntry) <= header->file_bytes;
+    const auto* levels = ok ? reinterpret_cast<const LevelEntry*>(base + header->levels_offset) : nullptr;
+    for (int j = 1; ok && j <= k; ++j) {
+        ok = levels[j].offset % sizeof(int32_t) == 0 &&
+             levels[j].count <= header->file_bytes / sizeof(int32_t) &&
+             levels[j].offset + levels[j].count * j * sizeof(int32_t) <= header->file_bytes;
+    }
+    if (ok) {
+        for (int j = 1; j <= k; ++j) {
+            const auto* ids = reinterpret_cast<const int32_t*>(base + levels[j].offset);
+            H[j] = ClusterLevel::mapped(j, mapping, ids, levels[j].count * j);
+        }
+    }
+    return ok;
+}
+
+
+// --- 最佳簇选择 (伪代码第12-17行) ---
+
+/**
+ * @brief 事务 P_j 的属性：w_j (等待时间), e_j (事务优先级), a_j (设备优先级)
+ */
+struct TransactionAttributes {
+    double waiting_time;
+    double priority;
+    double device_priority;
+};
+
+/**
+ * @brief R(C_t) 中三项属性的权重
+ */
+struct ScoreWeights {
+    double waiting_time = 1.0;
+    double priority = 1.0;
+    double device_priority = 1.0;
+};
+
+/**
+ * @brief 单个事务对 R(C_t) 的贡献 r_j = α·w_j + β·e_j + γ·a_j
+ */
+double transaction_score(const TransactionAttributes& t, const ScoreWeights& weights) {
+    return weights.waiting_time * t.waiting_time + weights.priority * t.priority +
+           weights.device_priority * t.device_priority;
+}
+
+/**
+ * @brief R(C_t) = Σ_{P_j ∈ C_t} r_j，按簇内升序 id 累加
+ * @param attributes 下标为事务 ID (1..n)，下标 0 不用
+ */
+double cluster_score(const int32_t* ids, int width, const std::vector<TransactionAttributes>& attributes,
+                     const ScoreWeights& weights) {
+    double score = 0.0;
+    for (int m = 0; m < width; ++m) score += transaction_score(attributes[ids[m]], weights);
+    return score;
+}
+
+struct ScoredCluster {
+    double score;
+    std::vector<int32_t> ids;   // 升序
+};
+
+/**
+ * @brief 排序规则：R 大的在前，R 相同时 id 字典序小的在前
+ */
+bool better_cluster(const ScoredCluster& a, const ScoredCluster& b) {
+    if (a.score != b.score) return a.score > b.score;
+    return a.ids < b.ids;
+}
+
+/**
+ * @brief 不构建 H_k，直接找出 R(C_t) 最大的 m 个大小为 k 的簇（分支定界）。
+ *
+ * 按扩展规则，升序的 {i_1 < ... < i_k} 属于 H_k 当且仅当对每个 m < k 都有 {i_{m+1}..i_k} ⊆ L_{i_m}^l。
+ * 因此按 id 升序逐个选点做深度优先搜索：已选 i_1..i_d 后，下一个点只能取自
+ * L_{i_1}^l ∩ ... ∩ L_{i_d}^l（其中的 id 都大于 i_d，每个簇恰好被找到一次）。
+ * 候选按 r_j 降序展开；部分簇的上界 = 已选得分 + 当前点得分 + 其余候选中最大的 (k-d-1) 个 r_j，
+ * 上界低于目前第 m 名时，这个点以及排在它后面的候选都可以整体剪掉。
+ * @param attributes 下标为事务 ID (1..n)
+ * @return 至多 m 个簇，按 better_cluster 排序；与对完整 H_k 评分后排序取前 m 个的结果相同
+ */
+std::vector<ScoredCluster> find_best_clusters(NeighborhoodIndex& index,
+                                              const std::vector<TransactionAttributes>& attributes,
+                                              const ScoreWeights& weights, int k, int l, int n, int m) {
+    std::vector<ScoredCluster> best;
+    if (k < 1 || m < 1 || n < 1) return best;
+    index.prepare(l);
+
+    std::vector<double> r(n + 1, 0.0);
+    for (int id = 1; id <= n; ++id) r[id] = transaction_score(attributes[id], weights);
+
+    const int word_count = (n + 1 + 63) / 64;
+    // 第 d 行：已选 d 个点后的候选位集
+    std::vector<uint64_t> candidates((k + 1) * word_count, 0);
+    for (int id = 1; id <= n; ++id) {
+        if (index.present(id)) candidates[id >> 6] |= uint64_t(1) << (id & 63);
+    }
+    std::vector<int32_t> chosen(k);
+    std::vector<std::vector<int32_t>> order(k);     // 每层按 r 降序排列的候选
+
+    // 浮点累加顺序不同带来的误差，避免把与第 m 名同分的簇错误剪掉
+    auto below_worst = [&](double bound) {
+        if (static_cast<int>(best.size()) < m) return false;
+        double worst = best.back().score;
+        return bound + 1e-9 * (std::abs(bound) + 1.0) < worst;
+    };
+
+    // score 是按选点顺序累加的部分得分，只用于上界；完成的簇按 cluster_score 重新求和，
+    // 与对 H_k 逐个评分的结果逐位相同，同分簇的排序才不受累加顺序影响
+    auto search = [&](auto&& self, int d, double score) -> void {
+        if (d == k) {
+            ScoredCluster cluster{cluster_score(chosen.data(), k, attributes, weights), chosen};
+            if (static_cast<int>(best.size()) == m && !better_cluster(cluster, best.back())) return;
+            best.insert(std::upper_bound(best.begin(), best.end(), cluster, better_cluster), std::move(cluster));
+            if (static_cast<int>(best.size()) > m) best.pop_back();
+            return;
+        }
+        const uint64_t* row = &candidates[d * word_count];
+        std::vector<int32_t>& ids = order[d];
+        ids.clear();
+        for (int w = 0; w < word_count; ++w) {
+            for (uint64_t bits = row[w]; bits != 0; bits &= bits - 1) ids.push_back(w * 64 + __builtin_ctzll(bits));
+        }
+        const int remaining = k - d;
+        if (static_cast<int>(ids.size()) < remaining) return;
+        std::sort(ids.begin(), ids.end(), [&](int32_t a, int32_t b) { return r[a] != r[b] ? r[a] > r[b] : a < b; });
+
+        // top：最大的 (remaining - 1) 个 r 之和。第 p 个候选的上界 = score + r_x + 其余候选中最大的
+        // (remaining - 1) 个之和；p 越靠后上界越小（不增），一旦低于第 m 名，后面的候选都不用再看
+        double top = 0.0;
+        for (int p = 0; p < remaining - 1; ++p) top += r[ids[p]];
+        const double next_best = r[ids[remaining - 1]];
+        for (size_t p = 0; p < ids.size(); ++p) {
+            const int32_t x = ids[p];
+            double bound = static_cast<int>(p) < remaining - 1 ? score + top + next_best : score + r[x] + top;
+            if (below_worst(bound)) break;
+
+            const BitRow Lx = index.prepared_row(x, l);
+            uint64_t* child = &candidates[(d + 1) * word_count];
+            for (int w = 0; w < word_count; ++w) child[w] = row[w] & Lx.words[w];
+            chosen[d] = x;
+            self(self, d + 1, score + r[x]);
+        }
+    };
+    search(search, 0, 0.0);
+    return best;
+}
+
+
+// --- 深度优先逐个生成 H_k ---
+
+/**
+ * @brief 不保存 H_1..H_{k-1}，按同一扩展规则深度优先地逐个生成 H_k 中的簇（拉取式迭代器）。
+ *
+ * 与 find_best_clusters 相同，升序的 {i_1 < ... < i_k} 属于 H_k 当且仅当每个 i_{m+1}..i_k 都在 L_{i_m}^l 中，
+ * 所以第 d 层的候选就是前 d 个已选点的 L^l 位集之交。每个簇只走到一次，
+ * 内存只有 (k + 1) 行候选位集和 k 个游标，与 |H_j| 无关。
+ * 生成顺序与 build_levels 得到的 H[k] 完全相同：前 k-1 个位置按 id 递减，最后一个位置按 id 递增。
+ */
+class ClusterEnumerator {
+public:
+    ClusterEnumerator(NeighborhoodIndex& index, int k, int l, int n)
+        : index_(index), k_(k), l_(l), word_count_((n + 1 + 63) / 64),
+          candidates_((k > 0 ? k : 0) * word_count_, 0), cursor_(k > 0 ? k : 0), chosen_(k > 0 ? k : 0) {
+        if (k < 1 || n < 1) return;
+        index_.prepare(l);
+        for (int id = 1; id <= n; ++id) {
+            if (index.present(id)) candidates_[id >> 6] |= uint64_t(1) << (id & 63);
+        }
+        start_level(0);
+        depth_ = 0;
+    }
+
+    /**
+     * @brief 取下一个簇（k 个升序 id）；全部生成完后返回 nullptr。
+     *        返回的指针只在下一次调用 next() 之前有效。
+     */
+    const int32_t* next() {
+        while (depth_ >= 0) {
+            const int d = depth_;
+            const uint64_t* row = &candidates_[d * word_count_];
+            const int x = d == k_ - 1 ? lowest_above(row, cursor_[d]) : highest_below(row, cursor_[d]);
+            if (x < 0) {
+                --depth_;   // 这一层的候选用完，回溯
+                continue;
+            }
+            cursor_[d] = x;
+            chosen_[d] = x;
+            if (d == k_ - 1) return chosen_.data();
+
+            // 下一层候选 = 本层候选 ∩ L_x^l，剩下的候选不够凑满 k 个时不用往下走
+            const BitRow Lx = index_.prepared_row(x, l_);
+            uint64_t* child = &candidates_[(d + 1) * word_count_];
+            int count = 0;
+            for (int w = 0; w < word_count_; ++w) {
+                child[w] = row[w] & Lx.words[w];
+                count += __builtin_popcountll(child[w]);
+            }
+            if (count >= k_ - d - 1) {
+                start_level(d + 1);
+                depth_ = d + 1;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    // 游标：递减的层只看 id < cursor 的位，递增的最后一层只看 id > cursor 的位
+    void start_level(int d) {
+        cursor_[d] = d == k_ - 1 ? -1 : word_count_ * 64;
+    }
+
+    // row 中小于 limit 的最大 id，没有返回 -1
+    int highest_below(const uint64_t* row, int limit) const {
+        if (limit <= 0) return -1;
+        int w = (limit - 1) >> 6;
+        uint64_t bits = row[w] & (~uint64_t(0) >> (63 - ((limit - 1) & 63)));
+        while (true) {
+            if (bits != 0) return w * 64 + 63 - __builtin_clzll(bits);
+            if (--w < 0) return -1;
+            bits = row[w];
+        }
+    }
+
+    // row 中大于 limit 的最小 id，没有返回 -1
+    int lowest_above(const uint64_t* row, int limit) const {
+        int first = limit + 1;
+        int w = first >> 6;
+        if (w >= word_count_) return -1;
+        uint64_t bits = row[w] & (~uint64_t(0) << (first & 63));
+        while (true) {
+            if (bits != 0) return w * 64 + __builtin_ctzll(bits);
+            if (++w >= word_count_) return -1;
+            bits = row[w];
+        }
+    }
+
+    NeighborhoodIndex& index_;
+    int k_;
+    int l_;
+    int word_count_;
+    std::vector<uint64_t> candidates_;  // 第 d 行：已选 d 个点后的候选位集
+    std::vector<int> cursor_;
+    std::vector<int32_t> chosen_;
+    int depth_ = -1;
+};
+
+// --- 算法输入数据 ---
+
+/**
+ * @brief 步骤 0: 设置算法1的输出 (来自 image_67435b.png 和 algorithm1.c)
+ * @return 包含23条边的邻接表
+ */
+std::map<int, std::set<int>> setupAdjacencyList_Edges() {
+    std::map<int, std::set<int>> adj;
+    
+    // 初始化所有10个点
+    for (int i = 1; i <= 10; ++i) {
+        adj[i] = {};
+    }
+
+    // 23条边的列表 
+    std::vector<std::pair<int, int>> edges = {
+        {8, 9}, {9, 10}, {8, 10},
+        {7, 8}, {7, 10},
+        {6, 7}, {6, 8}, {6, 9},
+        {5, 6}, {5, 7}, {5, 10},
+        {3, 4}, {3, 5},
+        {4, 5}, {4, 6}, {4, 9},
+        {2, 3}, {2, 4}, {2, 5}, {2, 10},
+        {1, 2}, {1, 4}, {1, 9}
+    };
+
+    // 构建邻接表
+    for (const auto& edge : edges) {
+        adj[edge.first].insert(edge.second);
+        adj[edge.second].insert(edge.first);
+    }
+    
+    return adj;
+}
+
+/**
+ * @brief 步骤 0: 各事务的 w_j, e_j, a_j（示例数据；算法1只给出了可见边，没有这些属性）
+ * @return 下标为事务 ID 1..10，下标 0 不用
+ */
+std::vector<TransactionAttributes> setupTransactionAttributes() {
+    return {
+        {0, 0, 0},
+        {5.0, 2.0, 1.0}, {3.0, 1.0, 2.0}, {8.0, 3.0, 1.0}, {1.0, 1.0, 1.0}, {6.0, 2.0, 3.0},
+        {2.0, 3.0, 2.0}, {4.0, 1.0, 1.0}, {7.0, 2.0, 2.0}, {3.0, 3.0, 1.0}, {9.0, 1.0, 3.0}
+    };
+}
+
+/**
+ * @brief H_{j-1} 的前缀树索引：按簇内升序 id 逐层分支，一条根到叶的路径就是一个簇。
+ *        扩展 P_i 时只沿着 id 属于 L_i^l 的分支往下走，走到叶子的簇即 C_t ⊆ L_i^l 的簇；
+ *        不在 L_i^l 里的分支整棵跳过，代价与成功扩展的数量（及它们的前缀）成正比，而不是 |H_{j-1}|。
+ *        L_i^l 中的 id 都大于 i，所以 all_gt_i 的条件自动满足。
+ */
+class ClusterIndex {
+public:
+    explicit ClusterIndex(const ClusterLevel& level) : width_(level.width()) {
+        order_.resize(level.size());
+        for (size_t c = 0; c < order_.size(); ++c) order_[c] = static_cast<uint32_t>(c);
+        std::sort(order_.begin(), order_.end(), [&](uint32_t a, uint32_t b) {
+            return std::lexicographical_compare(level[a], level[a] + width_, level[b], level[b] + width_);
+        });
+        nodes_.push_back(Node{0, 0, 0});    // 根
+        if (width_ > 0 && !order_.empty()) {
+            build(level, 0, 0, order_.size(), 0);
+        }
+    }
+
+    /**
+     * @brief 把所有 C_t ⊆ L 的簇在 H_{j-1} 中的下标按升序写入 matches
+     */
+    void find_subsets(BitRow L, std::vector<uint32_t>& matches) const {
+        matches.clear();
+        std::vector<uint32_t> stack{0};
+        while (!stack.empty()) {
+            const Node& node = nodes_[stack.back()];
+            stack.pop_back();
+            for (uint32_t child = node.begin; child < node.end; ++child) {
+                const Node& next = nodes_[child];
+                if (!L.test(next.id)) continue;
+                if (next.leaf) {
+                    matches.insert(matches.end(), order_.begin() + next.begin, order_.begin() + next.end);
+                } else {
+                    stack.push_back(child);
+                }
+            }
+        }
+        // 保持与逐个扫描 H_{j-1} 相同的顺序
+        std::sort(matches.begin(), matches.end());
+    }
+
+private:
+    // 内部节点的 [begin, end) 是子节点在 nodes_ 中的范围；叶子的是簇在 order_ 中的范围
+    struct Node {
+        int32_t id;
+        uint32_t begin;
+        uint32_t end;
+        bool leaf = false;
+    };
+
+    // order_[lo, hi) 的簇前 depth 个 id 相同，为它们在 nodes_[parent] 下建子节点
+    void build(const ClusterLevel& level, uint32_t parent, size_t lo, size_t hi, int depth) {
+        uint32_t first_child = static_cast<uint32_t>(nodes_.size());
+        std::vector<std::pair<size_t, size_t>> runs;
+        for (size_t a = lo; a < hi;) {
+            size_t b = a + 1;
+            while (b < hi && level[order_[b]][depth] == level[order_[a]][depth]) ++b;
+            nodes_.push_back(Node{level[order_[a]][depth], 0, 0});
+            runs.emplace_back(a, b);
+            a = b;
+        }
+        nodes_[parent].begin = first_child;
+        nodes_[parent].end = static_cast<uint32_t>(nodes_.size());
+        for (size_t r = 0; r < runs.size(); ++r) {
+            uint32_t child = first_child + static_cast<uint32_t>(r);
+            if (depth + 1 == width_) {
+                nodes_[child].leaf = true;
+                nodes_[child].begin = static_cast<uint32_t>(runs[r].first);
+                nodes_[child].end = static_cast<uint32_t>(runs[r].second);
+            } else {
+                build(level, child, runs[r].first, runs[r].second, depth + 1);
+            }
+        }
+    }
+
+    int width_;
+    std::vector<uint32_t> order_;   // 按 id 字典序排列的簇下标
+    std::vector<Node> nodes_;
+};
+
+/**
+ * @brief 算法2 伪代码第5-10行：用 P_i 扩展 H_{j-1} 中的每个簇，成功的加入 H_j。
+ *        逐个检查并打印每个 C_t，只在文本跟踪时使用；否则见 extend_level。
+ */
+void extend_with_pi(const ClusterLevel& previous, ClusterLevel& next, int Pi_id, BitRow Li, int j, int l) {
+    const int width = previous.width();
+    // 第5行: for each C_t in H_{j-1}
+    for (size_t c = 0; c < previous.size(); ++c) {
+        const int32_t* Ct = previous[c];
+
+        // 优化：只检查那些在 P_i "右侧" (ID更大) 的簇；簇内 id 升序，只看最小的一个
+        if (Ct[0] <= Pi_id) {
+            continue; // 跳过 C_t = {P_m, ...} m <= i 的情况
+        }
+
+        if constexpr (TRACE_TEXT_ENABLED) {
+            std::cout << "      - 检查 H_" << (j - 1) << " 中的 C_t = ";
+            print_cluster(Ct, width);
+            std::cout << std::endl;
+        }
+
+        // 第6行: if C_t subset L_i^l
+        if (is_ct_subset_li(Ct, width, Li)) {
+            // 第7行: H_j <- H_j U {P_i, C_t}，P_i 比 C_t 中所有 id 都小，放在最前面保持升序
+            next.add_extended(Pi_id, Ct);
+
+            if constexpr (TRACE_TEXT_ENABLED) {
+                std::cout << "         -> OK! C_t 是 L_" << Pi_id << "^" << l << " 的子集。" << std::endl;
+                std::cout << "         -> 创建新 H_" << j << " 簇: ";
+                print_cluster(next[next.size() - 1], j);
+                std::cout << std::endl;
+            }
+            TRACE_EVENT("      -> 创建新 H_%d 簇 (P%d + H_%d 中的第 %d 个簇)\n",
+                        j, Pi_id, j - 1, static_cast<int>(c));
+        } else {
+            if constexpr (TRACE_TEXT_ENABLED) {
+                std::cout << "         -> 失败! C_t 不是 L_" << Pi_id << "^" << l << " 的子集。" << std::endl;
+            }
+        }
+    }
+}
+
+/**
+ * @brief 任务下标 [0, task_count) 的工作窃取调度：每个线程先拿到连续的一段，
+ *        从自己那段的前端逐个取；取完后从其他线程那段的后端偷走一半。
+ *        每段是打包成一个 64 位原子量的 [begin, end)，取和偷都用 CAS。
+ */
+class WorkStealingRanges {
+public:
+    WorkStealingRanges(uint32_t task_count, int thread_count) : slots_(thread_count) {
+        for (int w = 0; w < thread_count; ++w) {
+            uint64_t begin = uint64_t(task_count) * w / thread_count;
+            uint64_t end = uint64_t(task_count) * (w + 1) / thread_count;
+            slots_[w].range.store(pack(begin, end));
+        }
+    }
+
+    /**
+     * @brief 为线程 worker 取下一个任务；所有任务都已被领走时返回 false
+     */
+    bool next(int worker, uint32_t& task) {
+        std::atomic<uint64_t>& own = slots_[worker].range;
+        for (uint64_t range = own.load(); begin_of(range) < end_of(range);) {
+            if (own.compare_exchange_weak(range, pack(begin_of(range) + 1, end_of(range)))) {
+                task = begin_of(range);
+                return true;
+            }
+        }
+        // 自己的段空了：依次尝试从其他线程偷一半（只有偷的一方会写空段，所以直接 store）
+        const int count = static_cast<int>(slots_.size());
+        for (int step = 1; step < count; ++step) {
+            std::atomic<uint64_t>& victim = slots_[(worker + step) % count].range;
+            for (uint64_t range = victim.load(); begin_of(range) < end_of(range);) {
+                uint32_t begin = begin_of(range), end = end_of(range);
+                uint32_t middle = begin + (end - begin) / 2;
+                if (victim.compare_exchange_weak(range, pack(begin, middle))) {
+                    own.store(pack(middle + 1, end));
+                    task = middle;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    static uint64_t pack(uint64_t begin, uint64_t end) { return (begin << 32) | end; }
+    static uint32_t begin_of(uint64_t range) { return static_cast<uint32_t>(range >> 32); }
+    static uint32_t end_of(uint64_t range) { return static_cast<uint32_t>(range); }
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> range;
+    };
+    std::vector<Slot> slots_;
+};
+
+/**
+ * @brief 常驻的工作线程：build_levels 开始时创建一次，之后每一层的 extend_level 都复用，
+ *        不必每层重新创建、回收线程。run(job) 在每个线程上各调用一次 job(worker)
+ *        （worker 0 是调用线程自己），全部返回后 run 才返回。
+ */
+class LevelWorkerPool {
+public:
+    explicit LevelWorkerPool(int thread_count) : thread_count_(thread_count < 1 ? 1 : thread_count) {
+        for (int w = 1; w < thread_count_; ++w) threads_.emplace_back([this, w] { worker_main(w); });
+    }
+
+    ~LevelWorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        work_ready_.notify_all();
+        for (auto& thread : threads_) thread.join();
+    }
+
+    LevelWorkerPool(const LevelWorkerPool&) = delete;
+    LevelWorkerPool& operator=(const LevelWorkerPool&) = delete;
+
+    int size() const { return thread_count_; }
+
+    void run(const std::function<void(int)>& job) {
+        if (thread_count_ == 1) {
+            job(0);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &job;
+            running_ = thread_count_ - 1;
+            ++generation_;
+        }
+        work_ready_.notify_all();
+        job(0);
+        std::unique_lock<std::mutex> lock(mutex_);
+        work_done_.wait(lock, [this] { return running_ == 0; });
+        job_ = nullptr;
+    }
+
+private:
+    void worker_main(int worker) {
+        uint64_t seen_generation = 0;
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            work_ready_.wait(lock, [&] { return stop_ || generation_ != seen_generation; });
+            if (stop_) return;
+            seen_generation = generation_;
+            const std::function<void(int)>* job = job_;
+            lock.unlock();
+            (*job)(worker);
+            lock.lock();
+            if (--running_ == 0) work_done_.notify_one();
+        }
+    }
+
+    int thread_count_;
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable work_ready_;
+    std::condition_variable work_done_;
+    const std::function<void(int)>* job_ = nullptr;
+    int running_ = 0;                   // 本轮尚未完成的后台线程数
+    uint64_t generation_ = 0;           // 每发布一轮任务加一
+    bool stop_ = false;
+};
+
+/**
+ * @brief 两个升序 id 数组的交集写入 out（out 至少能放 min(a_count, b_count) 个），返回交集大小。
+ *        有 SSE2 时每次比较 a、b 各 4 个元素：b 的 4 个轮转三次与 a 逐位比较，得到 a 中命中的位置；
+ *        两块中最大值较小的一方前进，剩下不足 4 个的部分做普通归并。
+ */
+int intersect_sorted(const int32_t* a, int a_count, const int32_t* b, int b_count, int32_t* out) {
+    int i = 0, j = 0, count = 0;
+#if defined(__SSE2__)
+    while (i + 4 <= a_count && j + 4 <= b_count) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+        __m128i hit = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(va, vb), _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+            _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+                         _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+        for (int mask = _mm_movemask_ps(_mm_castsi128_ps(hit)); mask != 0; mask &= mask - 1) {
+            out[count++] = a[i + __builtin_ctz(mask)];
+        }
+        const int32_t a_last = a[i + 3], b_last = b[j + 3];
+        if (a_last <= b_last) i += 4;
+        if (b_last <= a_last) j += 4;
+    }
+#endif
+    while (i < a_count && j < b_count) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (b[j] < a[i]) {
+            ++j;
+        } else {
+            out[count++] = a[i];
+            ++i;
+            ++j;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief 不经过 H_{j-1}，直接按 build_levels 的顺序列出 H_j 的所有簇并追加到 out。
+ *        L 为编译期确定的 l；一般情况用 ClusterEnumerator 在 L_i^l 位集上深度优先搜索。
+ */
+template <int L>
+void list_level(NeighborhoodIndex& index, int j, int n, ClusterLevel& out) {
+    ClusterEnumerator clusters(index, j, L, n);
+    while (const int32_t* Ct = clusters.next()) out.ids().insert(out.ids().end(), Ct, Ct + j);
+}
+
+/**
+ * @brief l = 1 的特化：L_i^1 就是 P_i 的 ID 更大的邻居，H_j 即按 id 升序排列的所有 j-团。
+ *        不构建 L_i^l 位集，只用每个事务 ID 更大的邻居的升序数组；第 d 层候选是前 d 个点的邻居数组之交，
+ *        用 intersect_sorted 求出。候选不够凑满 j 个的分支直接跳过。
+ */
+template <>
+void list_level<1>(NeighborhoodIndex& index, int j, int n, ClusterLevel& out) {
+    if (j < 1) return;
+    index.prepare_forward();
+    std::vector<std::vector<int32_t>> candidates(j);
+    for (int id = 1; id <= n; ++id) {
+        if (index.present(id)) candidates[0].push_back(id);
+    }
+    std::vector<int32_t> chosen(j);
+    std::vector<int32_t>& ids = out.ids();
+
+    auto search = [&](auto&& self, int d) -> void {
+        const std::vector<int32_t>& current = candidates[d];
+        if (d == j - 1) {
+            // 最后一个位置按 id 递增
+            for (int32_t x : current) {
+                ids.insert(ids.end(), chosen.begin(), chosen.begin() + d);
+                ids.push_back(x);
+            }
+            return;
+        }
+        const int needed = j - d - 1;
+        std::vector<int32_t>& next = candidates[d + 1];
+        // 前面的位置按 id 递减；x 之后的候选（都比 x 大）不够 needed 个时不必再看
+        for (int p = static_cast<int>(current.size()) - 1 - needed; p >= 0; --p) {
+            const int32_t x = current[p];
+            const int32_t* neighbors = index.forward_begin(x);
+            const int degree = static_cast<int>(index.forward_end(x) - neighbors);
+            if (degree < needed) continue;
+            const int rest = static_cast<int>(current.size()) - p - 1;
+            next.resize(std::min(rest, degree));
+            next.resize(intersect_sorted(current.data() + p + 1, rest, neighbors, degree, next.data()));
+            if (static_cast<int>(next.size()) < needed) continue;
+            chosen[d] = x;
+            self(self, d + 1);
+        }
+    };
+    search(search, 0);
+}
+
+/**
+ * @brief 用索引构建一层 H_j（伪代码第4-10行）。每个 P_i 只读 H_{j-1} 和 L_i^l，彼此独立：
+ *        pool 有多个线程时按工作窃取分给各线程（不同 P_i 的工作量差别很大），
+ *        每个线程写自己的缓冲区，最后按 i 递减的顺序拼接，结果与串行完全相同。
+ */
+void extend_level(const ClusterLevel& previous, ClusterLevel& next, NeighborhoodIndex& index,
+                  int j, int l, int n, LevelWorkerPool& pool) {
+    const ClusterIndex trie(previous);
+    index.prepare(l);
+    const uint32_t task_count = n - j + 1 > 0 ? n - j + 1 : 0;   // 任务 t 对应 P_i，i = n - j + 1 - t
+    int thread_count = pool.size();
+    if (thread_count > static_cast<int>(task_count)) thread_count = task_count > 0 ? task_count : 1;
+
+    struct WorkerOutput {
+        std::vector<int32_t> ids;
+        std::vector<uint32_t> sources;  // 每个新簇来自 H_{j-1} 中的第几个簇（二进制跟踪用）
+        std::vector<uint32_t> matches;
+    };
+    struct TaskOutput {
+        int worker;
+        size_t begin;   // 在该线程缓冲区中的簇范围
+        size_t end;
+    };
+    std::vector<WorkerOutput> outputs(thread_count);
+    std::vector<TaskOutput> tasks(task_count);
+    WorkStealingRanges ranges(task_count, thread_count);
+
+    auto run = [&](int worker) {
+        WorkerOutput& out = outputs[worker];
+        uint32_t t;
+        while (ranges.next(worker, t)) {
+            int Pi_id = n - j + 1 - static_cast<int>(t);
+            // 第5-7行：只取出 C_t ⊆ L_i^l 的簇
+            trie.find_subsets(index.prepared_row(Pi_id, l), out.matches);
+            size_t begin = out.ids.size() / j;
+            for (uint32_t c : out.matches) {
+                out.ids.push_back(Pi_id);
+                out.ids.insert(out.ids.end(), previous[c], previous[c] + j - 1);
+                if constexpr (TRACE_BINARY_ENABLED) out.sources.push_back(c);
+            }
+            tasks[t] = TaskOutput{worker, begin, out.ids.size() / j};
+        }
+    };
+    // 任务比线程少时多出的线程直接返回
+    pool.run([&](int worker) {
+        if (worker < thread_count) run(worker);
+    });
+
+    // 按 i 递减拼接
+    for (uint32_t t = 0; t < task_count; ++t) {
+        const TaskOutput& task = tasks[t];
+        const WorkerOutput& out = outputs[task.worker];
+        next.ids().insert(next.ids().end(), out.ids.begin() + task.begin * j, out.ids.begin() + task.end * j);
+        if constexpr (TRACE_BINARY_ENABLED) {
+            [[maybe_unused]] int Pi_id = n - j + 1 - static_cast<int>(t);
+            TRACE_EVENT("   扫描 P_i = P%d: |L_i^l| = %d\n", Pi_id, index.prepared_row(Pi_id, l).count());
+            for (size_t c = task.begin; c < task.end; ++c) {
+                TRACE_EVENT("      -> 创建新 H_%d 簇 (P%d + H_%d 中的第 %d 个簇)\n",
+                            j, Pi_id, j - 1, static_cast<int>(out.sources[c]));
+            }
+        }
+    }
+}
+
+/**
+ * @brief 算法2 伪代码第1-11行：逐层构建 H_1..H_k，结果写入 H[1..k]
+ * @param H     大小为 k + 1，H[j] 为宽度 j 的空层
+ * @param index L_i^l 的索引，可在多次调用（不同 k、l）之间共用
+ * @param thread_count 并行扩展的线程数，线程只创建一次、各层共用；文本跟踪时总是串行，
+ *                     l = 1 时直接列出团（list_level<1>），不创建线程
+ */
+void build_levels(std::vector<ClusterLevel>& H, int k, int l, int n, NeighborhoodIndex& index,
+                  int thread_count = 1) {
+    // hardware_concurrency() 可能返回 0
+    if (thread_count < 1) thread_count = 1;
+    const bool extends = !TRACE_TEXT_ENABLED && (l != 1 || TRACE_BINARY_ENABLED) && k >= 2;
+    LevelWorkerPool pool(extends ? thread_count : 1);
+    // --- 算法2 伪代码 第1行: 初始化 H_1 ---
+    std::cout << "\n--- 1. 初始化 H_1 (j=1) ---" << std::endl;
+    for (int i = 1; i <= n; ++i) {
+        if (index.present(i)) H[1].add({i});
+    }
+    std::cout << "H_1 (共 " << H[1].size() << " 个簇): {";
+    for (size_t i = 0; i < H[1].size(); ++i) {
+        print_cluster(H[1][i], 1);
+        if (i < H[1].size() - 1) std::cout << ", ";
+    }
+    std::cout << "}" << std::endl;
+
+    // --- 算法2 伪代码 第3-11行: 迭代构建 H_j ---
+    for (int j = 2; j <= k; ++j) {
+        std::cout << "\n--- 2. 开始构建 H_" << j << " (j=" << j << ") ---" << std::endl;
+        if constexpr (!TRACE_TEXT_ENABLED) {
+            if (l == 1 && !TRACE_BINARY_ENABLED) {
+                // l = 1 时 H_j 就是所有 j-团，直接列出，不需要扫描 H_{j-1}（二进制跟踪要记录来源簇，仍走扩展）
+                list_level<1>(index, j, n, H[j]);
+            } else {
+                extend_level(H[j - 1], H[j], index, j, l, n, pool);
+            }
+        } else {
+            // 文本跟踪逐个打印每个 P_i、每个 C_t 的检查过程，串行走完整扫描
+            // 第4行: for i = n-j+1; i >= 1; i--
+            for (int i = n - j + 1; i >= 1; --i) {
+                int Pi_id = i;
+
+                // 计算 L_i^l (P_i 的 l-层 "右侧" 邻居)
+                const BitRow Li = index.right_neighbors(Pi_id, l);
+
+                std::cout << "\n   扫描 P_i = P" << Pi_id << ":" << std::endl;
+                std::cout << "      L_" << Pi_id << "^" << l << " (l=" << l << " 跳可达且 ID > " << Pi_id << "): ";
+                print_bits(Li);
+                std::cout << std::endl;
+
+                extend_with_pi(H[j - 1], H[j], Pi_id, Li, j, l);
+            }
+        }
+        
+        std::cout << "\n--- H_" << j << " 构建完成 (共 " << H[j].size() << " 个簇) ---" << std::endl;
+        // 打印所有 H_j 的内容
+        if constexpr (TRACE_TEXT_ENABLED) {
+            for (size_t i = 0; i < H[j].size(); ++i) {
+                print_cluster(H[j][i], j);
+                if ((i + 1) % 5 == 0) std::cout << std::endl; // 每5个换行
+                else if (i < H[j].size() - 1) std::cout << ", ";
+            }
+            std::cout << std::endl;
+        }
+    }
+}
+
+// --- 交易池变化后的增量更新 ---
+
+/**
+ * @brief build_levels 给出的 H_j 顺序：前 j-1 个位置按 id 递减，最后一个位置按 id 递增
+ */
+bool canonical_less(const int32_t* a, const int32_t* b, int width) {
+    for (int m = 0; m < width - 1; ++m) {
+        if (a[m] != b[m]) return a[m] > b[m];
+    }
+    return a[width - 1] < b[width - 1];
+}
+
+/**
+ * @brief 把平铺的簇按 canonical_less 排序
+ */
+void sort_clusters(std::vector<int32_t>& ids, int width) {
+    const size_t count = ids.size() / width;
+    std::vector<uint32_t> order(count);
+    for (size_t c = 0; c < count; ++c) order[c] = static_cast<uint32_t>(c);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return canonical_less(&ids[a * width], &ids[b * width], width);
+    });
+    std::vector<int32_t> sorted;
+    sorted.reserve(ids.size());
+    for (uint32_t c : order) sorted.insert(sorted.end(), &ids[c * width], &ids[c * width] + width);
+    ids.swap(sorted);
+}
+
+/**
+ * @brief 在新图（previous 为 false）或最近一次 apply_delta 之前的旧图中，找出所有至少含一个 D 中事务的簇，
+ *        大小为 j 的放入 clusters[j]（平铺、未排序）。
+ *        合法簇的前缀仍是合法簇，所以一次深度优先搜索（第 d 层候选 = 已选点的 L^l 之交）就得到所有层；
+ *        簇的最小元素要么在 D 中，要么与簇内某个更大的 D 中事务相距不超过 l 跳，所以只从 reach(D, l) 出发，
+ *        还没选到 D 中事务、候选里也没有 D 中事务的分支直接跳过。
+ */
+void collect_touching_clusters(const NeighborhoodIndex& index, const std::vector<uint64_t>& D, int k, int l,
+                               bool previous, std::vector<std::vector<int32_t>>& clusters) {
+    const int words = index.word_count();
+    std::vector<uint64_t> candidates(k * words, 0);     // 第 d 行：已选 d 个点后的候选位集
+    std::vector<uint64_t> roots = index.reach(D, l, previous);
+    for (int w = 0; w < words; ++w) {
+        for (uint64_t bits = roots[w]; bits != 0; bits &= bits - 1) {
+            const int id = w * 64 + __builtin_ctzll(bits);
+            if (previous ? index.was_present(id) : index.present(id)) candidates[w] |= uint64_t(1) << (id & 63);
+        }
+    }
+    std::vector<int32_t> chosen(k);
+
+    auto search = [&](auto&& self, int d, bool touching) -> void {
+        const uint64_t* row = &candidates[d * words];
+        for (int w = 0; w < words; ++w) {
+            for (uint64_t bits = row[w]; bits != 0; bits &= bits - 1) {
+                const int x = w * 64 + __builtin_ctzll(bits);
+                const bool has = touching || ((D[x >> 6] >> (x & 63)) & 1);
+                chosen[d] = x;
+                if (has) clusters[d + 1].insert(clusters[d + 1].end(), chosen.begin(), chosen.begin() + d + 1);
+                if (d + 1 == k) continue;
+
+                const BitRow Lx = previous ? index.previous_row(x, l) : index.prepared_row(x, l);
+                uint64_t* child = &candidates[(d + 1) * words];
+                bool any = false, reaches = false;
+                for (int v = 0; v < words; ++v) {
+                    child[v] = row[v] & Lx.words[v];
+                    any |= child[v] != 0;
+                    reaches |= (child[v] & D[v]) != 0;
+                }
+                if (any && (has || reaches)) self(self, d + 1, has);
+            }
+        }
+    };
+    search(search, 0, false);
+}
+
+/**
+ * @brief 从 level 中删去 removed 中的簇、并入 added 中的簇（两者都已按 canonical_less 排好），
+ *        结果仍按 canonical_less 排列。第一个受影响位置之前的簇原样不动，之后的部分一次归并完成。
+ */
+void merge_level(ClusterLevel& level, const std::vector<int32_t>& removed, const std::vector<int32_t>& added) {
+    const int width = level.width();
+    const size_t count = level.size();
+    const size_t removed_count = removed.size() / width, added_count = added.size() / width;
+    if (removed_count == 0 && added_count == 0) return;
+
+    // 第一个不小于 removed[0] / added[0] 的位置
+    const int32_t* key = removed_count == 0 ? &added[0]
+                       : added_count == 0 || canonical_less(&removed[0], &added[0], width) ? &removed[0] : &added[0];
+    size_t lo = 0, hi = count;
+    while (lo < hi) {
+        size_t middle = (lo + hi) / 2;
+        if (canonical_less(level[middle], key, width)) lo = middle + 1;
+        else hi = middle;
+    }
+
+    std::vector<int32_t> tail;
+    size_t c = lo, r = 0, a = 0;
+    while (c < count || a < added_count) {
+        if (c < count) {
+            const int32_t* current = level[c];
+            while (r < removed_count && canonical_less(&removed[r * width], current, width)) ++r;
+            if (r < removed_count && std::equal(current, current + width, &removed[r * width])) {
+                ++c;
+                ++r;
+                continue;
+            }
+            if (a == added_count || canonical_less(current, &added[a * width], width)) {
+                tail.insert(tail.end(), current, current + width);
+                ++c;
+                continue;
+            }
+        }
+        tail.insert(tail.end(), &added[a * width], &added[a * width] + width);
+        ++a;
+    }
+    std::vector<int32_t>& ids = level.ids();
+    ids.resize(lo * width);
+    ids.insert(ids.end(), tail.begin(), tail.end());
+}
+
+/**
+ * @brief 交易池变化后原地更新 H_1..H_k，不再从头重建。
+ *
+ * 设 D = L^l 行改变了的事务 ∪ 进出池的事务。不含 D 中事务的簇，成员和成员的 L^l 行都没有变，
+ * 是否合法也不变；所以只需删去旧图中含 D 的簇、并入新图中含 D 的簇。L^l 只重算变化边附近的行
+ * (NeighborhoodIndex::apply_delta)，两次搜索都从 D 附近出发，代价取决于变化周围的簇数而不是 |H_j|。
+ * 更新后的 H 与在新图上调用 build_levels 的结果相同（包括顺序）。
+ * @param index 构建 H 时使用的索引，随 delta 一起更新
+ */
+void update_levels(std::vector<ClusterLevel>& H, int k, int l, NeighborhoodIndex& index, const GraphDelta& delta) {
+    index.prepare(l);
+    index.apply_delta(delta);
+    const int words = index.word_count();
+    std::vector<uint64_t> D(words, 0);
+    bool any = false;
+    auto mark = [&](int id) {
+        D[id >> 6] |= uint64_t(1) << (id & 63);
+        any = true;
+    };
+    for (int id : index.last_changes(l).ids) mark(id);
+    for (int id : delta.added_nodes) {
+        if (index.present(id) != index.was_present(id)) mark(id);
+    }
+    for (int id : delta.removed_nodes) {
+        if (index.present(id) != index.was_present(id)) mark(id);
+    }
+    if (!any || k < 1) return;
+
+    std::vector<std::vector<int32_t>> removed(k + 1), added(k + 1);
+    collect_touching_clusters(index, D, k, l, true, removed);
+    collect_touching_clusters(index, D, k, l, false, added);
+    for (int j = 1; j <= k; ++j) {
+        sort_clusters(removed[j], j);
+        sort_clusters(added[j], j);
+        merge_level(H[j], removed[j], added[j]);
+    }
+}
+
+// --- 主函数 ---
+
+int main(int argc, char* argv[]) {
+    // --- 步骤 0: 初始化参数 (l, k 可修改) ---
+    // =============================================
+    // =          在这里修改 l 和 k 的值          =
+    // =============================================
+    int k = 3;  // 目标簇大小 (例如: 3)
+    int l = 1;  // 邻接层数 (例如: 1)
+    // =============================================
+
+    const int n = 10; // 总事务数
+
+    // 命令行选项：
+    //   --stream           不保存 H_1..H_k，深度优先逐个生成 H_k 并直接输出
+    //   --snapshot <路径>  优先从快照恢复 H_1..H_k，恢复不了再计算并写入快照
+    bool stream = false;
+    const char* snapshot_path = nullptr;
+    for (int a = 1; a < argc; ++a) {
+        if (std::strcmp(argv[a], "--stream") == 0) {
+            stream = true;
+        } else if (std::strcmp(argv[a], "--snapshot") == 0 && a + 1 < argc) {
+            snapshot_path = argv[++a];
+        } else {
+            if (std::strcmp(argv[a], "--snapshot") == 0) std::cerr << "--snapshot 缺少路径" << std::endl;
+            else std::cerr << "未知参数: " << argv[a] << std::endl;
+            std::cerr << "用法: " << argv[0] << " [--stream] [--snapshot <路径>]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "--- 算法2: 交易打包选择算法  ---" << std::endl;
+    std::cout << "参数: K = " << k << ", L = " << l << std::endl;
+    std::cout << "输入: 算法1提供的 23 条可见边 " << std::endl;
+
+    // 获取算法1的输出 (G_vis)
+    std::map<int, std::set<int>> adj = setupAdjacencyList_Edges();
+    // L_i^l 的索引只建一次，构建 H_1..H_k 和查找最佳簇共用
+    NeighborhoodIndex index(adj, n);
+
+    if (stream) {
+        ClusterEnumerator clusters(index, k, l, n);
+        std::cout << "\n--- 深度优先生成 H_" << k << " 候选簇 ---" << std::endl;
+        size_t count = 0;
+        while (const int32_t* Ct = clusters.next()) {
+            std::cout << "   候选 " << ++count << ": ";
+            print_cluster(Ct, k);
+            std::cout << std::endl;
+        }
+        std::cout << "(共 " << count << " 个)" << std::endl;
+        return 0;
+    }
+
+    // H 是一个数组，索引代表簇的大小 j
+    // H[j] 包含所有大小为 j 的簇，每个簇为 j 个升序 id
+    std::vector<ClusterLevel> H;
+    for (int j = 0; j <= k; ++j) H.emplace_back(j);
+
+    // 第1-11行: 构建 H_1..H_k；给了快照路径时优先从快照恢复，恢复不了再计算并写入快照
+    if (snapshot_path != nullptr && load_levels(snapshot_path, H, k, l, n, adj)) {
+        std::cout << "\n--- 从快照 " << snapshot_path << " 恢复 H_1..H_" << k << " ---" << std::endl;
+    } else {
+        build_levels(H, k, l, n, index, static_cast<int>(std::thread::hardware_concurrency()));
+        if (snapshot_path != nullptr && !save_levels(snapshot_path, H, k, l, n, adj)) {
+            std::cout << "\n无法写入快照 " << snapshot_path << std::endl;
+        }
+    }
+
+    std::cout << "\n--- 算法2 执行完成 (j=" << k << ") ---" << std::endl;
+
+    std::cout << "\n--- 最终 H_" << k << " 候选簇列表 (共 " << H[k].size() << " 个) ---" << std::endl;
+    for (size_t i = 0; i < H[k].size(); ++i) {
+        std::cout << "   候选 " << (i + 1) << ": ";
+        print_cluster(H[k][i], k);
+        std::cout << std::endl;
+    }
+
+    // --- 算法2 伪代码 第12-17行: 按 R(C_t) 查找最佳簇 ---
+    // 分支定界直接在 L_i^l 上搜索，不依赖上面已构建的 H_k
+    const int m = 3;    // 需要的最佳簇个数
+    std::vector<TransactionAttributes> attributes = setupTransactionAttributes();
+    ScoreWeights weights;
+    std::vector<ScoredCluster> best = find_best_clusters(index, attributes, weights, k, l, n, m);
+
+    std::cout << "\n--- R(C_t) 最高的 " << best.size() << " 个 H_" << k << " 簇 ---" << std::endl;
+    for (size_t i = 0; i < best.size(); ++i) {
+        std::cout << "   第 " << (i + 1) << " 名: ";
+        print_cluster(best[i].ids.data(), k);
+        std::cout << "  R = " << best[i].score << std::endl;
+    }
+
+    TRACE_DUMP("algorithm2.trace");
+    return 0;
 }
\ No newline at end of file
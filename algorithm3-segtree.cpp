@@ -3,6 +3,9 @@
 #include <algorithm>
 #include <map>
 #include <iomanip>
+#include <limits>
+#include <thread>
+#include <atomic>
 
 using namespace std;
 
@@ -27,71 +30,147 @@ struct Event {
     }
 };
 
-// 线段树节点
-struct Node {
-    double max_val;     // 当前区间的最大权重
-    int max_idx;        // 最大权重对应的叶子节点索引 (代表具体的 Y 区间)
-    double lazy;        // 懒标记
-} tree[80005];          // 假设最多 20000 个矩形 -> 40000 个 Y 坐标 -> 树大小需 4 倍
-
-int n; // 离散化后的区间数量
-
-// 上推：父节点获取子节点的最大值信息
-void push_up(int node) {
-    if (tree[node * 2].max_val >= tree[node * 2 + 1].max_val) {
-        tree[node].max_val = tree[node * 2].max_val;
-        tree[node].max_idx = tree[node * 2].max_idx;
-    } else {
-        tree[node].max_val = tree[node * 2 + 1].max_val;
-        tree[node].max_idx = tree[node * 2 + 1].max_idx;
+// 线段树：区间加、查询全局最大值及其所在的叶子索引
+// 每次求解单独创建，大小由离散化后的区间数决定。自底向上、非递归：
+// 叶子个数补齐到 2 的幂，节点 p 的左右孩子为 2p、2p+1，叶子 i 位于 size + i；
+// 区间加不下推懒标记，内部节点的加值 add 永久留在节点上，
+// max_val[p] = max(max_val[2p], max_val[2p+1]) + add[p]。
+// max_val、max_idx、add 分别存放在连续数组中。
+class SegmentTree {
+public:
+    explicit SegmentTree(int n) : size_(1) {
+        while (size_ < n) size_ *= 2;
+        max_val_.assign(2 * size_, 0.0);
+        max_idx_.assign(2 * size_, 0);
+        add_.assign(size_, 0.0);
+        for (int i = 0; i < size_; ++i) {
+            max_idx_[size_ + i] = i; // 叶子节点记录自己的索引
+            // 补齐出来的叶子不对应任何 Y 区间，永远不会成为最大值
+            if (i >= n) max_val_[size_ + i] = -numeric_limits<double>::infinity();
+        }
+        for (int p = size_ - 1; p >= 1; --p) push_up(p);
     }
-}
 
-// 下推：懒标记下传
-void push_down(int node) {
-    if (tree[node].lazy != 0) {
-        double lz = tree[node].lazy;
-        
-        tree[node * 2].max_val += lz;
-        tree[node * 2].lazy += lz;
-        
-        tree[node * 2 + 1].max_val += lz;
-        tree[node * 2 + 1].lazy += lz;
-        
-        tree[node].lazy = 0;
+    // 区间 [l, r] 加上 val
+    void update(int l, int r, double val) {
+        int lo = l + size_, hi = r + size_ + 1;
+        for (; lo < hi; lo >>= 1, hi >>= 1) {
+            if (lo & 1) apply(lo++, val);
+            if (hi & 1) apply(--hi, val);
+        }
+        // 只有两端叶子到根路径上的节点需要重新计算
+        rebuild(l + size_);
+        rebuild(r + size_);
     }
-}
 
-// 建树
-void build(int node, int start, int end) {
-    tree[node].lazy = 0;
-    if (start == end) {
-        tree[node].max_val = 0;
-        tree[node].max_idx = start; // 叶子节点记录自己的索引
-        return;
+    double max_value() const { return max_val_[1]; }
+    int max_index() const { return max_idx_[1]; }
+
+private:
+    void apply(int node, double val) {
+        max_val_[node] += val;
+        if (node < size_) add_[node] += val;
+    }
+
+    // 上推：父节点获取子节点的最大值信息（相等时取左边，即索引最小的区间）
+    void push_up(int node) {
+        int child = max_val_[node * 2] >= max_val_[node * 2 + 1] ? node * 2 : node * 2 + 1;
+        max_val_[node] = max_val_[child] + add_[node];
+        max_idx_[node] = max_idx_[child];
+    }
+
+    void rebuild(int node) {
+        for (node >>= 1; node >= 1; node >>= 1) push_up(node);
+    }
+
+    int size_;                  // 叶子个数（2 的幂）
+    vector<double> max_val_;    // 当前区间的最大权重
+    vector<int> max_idx_;       // 最大权重对应的叶子节点索引 (代表具体的 Y 区间)
+    vector<double> add_;        // 内部节点上累积的区间加值
+};
+
+// 一个 Y 分片的扫描结果
+struct SlabResult {
+    double max_weight = -1.0;
+    int event = -1;     // 第一次取得该最大权重时，那一组事件中最后一个的下标
+    int y_idx = 0;      // 最大权重所在的离散 Y 区间（全局索引）
+};
+
+// 只扫描离散 Y 区间 [begin, end) 这一片：排好序的事件只读、各分片共用，
+// 事件的 Y 区间裁剪到本片后更新本片自己的线段树，其余逻辑与整体扫描相同
+SlabResult sweepSlab(const vector<Event>& events, int begin, int end) {
+    SlabResult result;
+    SegmentTree tree(end - begin);
+    for (size_t i = 0; i < events.size(); ++i) {
+        int l = max(events[i].y_start_idx, begin);
+        int r = min(events[i].y_end_idx, end - 1);
+        if (l <= r) tree.update(l - begin, r - begin, events[i].type * events[i].weight);
+
+        // 同一 X 的事件全部处理完后才比较
+        if (i == events.size() - 1 || events[i + 1].x > events[i].x) {
+            double current_max = tree.max_value();
+            if (current_max > result.max_weight) {
+                result.max_weight = current_max;
+                result.event = static_cast<int>(i);
+                result.y_idx = begin + tree.max_index();
+            }
+        }
     }
-    int mid = (start + end) / 2;
-    build(node * 2, start, mid);
-    build(node * 2 + 1, mid + 1, end);
-    push_up(node);
+    return result;
 }
 
-// 区间更新
-void update(int node, int start, int end, int l, int r, double val) {
-    if (l <= start && end <= r) {
-        tree[node].max_val += val;
-        tree[node].lazy += val;
-        return;
+// 一次扫描的结果：最大权重及其所在区域 [x1, x2] x [y1, y2]（没有事件时区域为 0）
+struct Selection {
+    double max_weight = -1.0;
+    double x1 = 0, x2 = 0;
+    double y1 = 0, y2 = 0;
+};
+
+// 扫描排好序的事件，Y 为离散化后的坐标；thread_count > 1 时把离散 Y 区间分成 thread_count 片并行扫描
+Selection sweepEvents(const vector<Event>& events, const vector<double>& Y, int thread_count) {
+    int n = static_cast<int>(Y.size()) - 1;
+
+    // 按 Y 分片，每片一个线程、一棵线段树，扫描全部事件
+    if (thread_count > n) thread_count = n;
+    if (thread_count < 1) thread_count = 1;
+    vector<SlabResult> slabs(thread_count);
+    vector<thread> threads;
+    for (int t = 1; t < thread_count; ++t) {
+        threads.emplace_back([&, t] {
+            slabs[t] = sweepSlab(events, n * t / thread_count, n * (t + 1) / thread_count);
+        });
+    }
+    slabs[0] = sweepSlab(events, 0, n / thread_count);
+    for (auto& worker : threads) worker.join();
+
+    // 合并：取最大权重；相同时取更早的 X 位置，再相同时取 Y 更小的分片。
+    // 整体扫描记录的是第一次达到全局最大值的 X 位置和其中索引最小的 Y 区间，与此一致
+    SlabResult best;
+    for (const auto& slab : slabs) {
+        if (slab.max_weight > best.max_weight ||
+            (slab.max_weight == best.max_weight && slab.event >= 0 && slab.event < best.event)) {
+            best = slab;
+        }
+    }
+
+    Selection result;
+    result.max_weight = best.max_weight;
+    if (best.event >= 0) {
+        // 记录 X 范围：当前事件 X 到 下一个事件 X
+        result.x1 = events[best.event].x;
+        // 防止越界读取下一个
+        result.x2 = (best.event == static_cast<int>(events.size()) - 1) ? result.x1 : events[best.event + 1].x;
+
+        // 获取 Y 范围：最大值所在的离散 Y 区间
+        result.y1 = Y[best.y_idx];
+        result.y2 = Y[best.y_idx + 1];
     }
-    push_down(node);
-    int mid = (start + end) / 2;
-    if (l <= mid) update(node * 2, start, mid, l, r, val);
-    if (r > mid) update(node * 2 + 1, mid + 1, end, l, r, val);
-    push_up(node);
+    return result;
 }
 
 // 核心算法函数
-pair<double, double> solveBlockSelection(vector<Block>& blocks) {
+// thread_count > 1 时把离散 Y 区间分成 thread_count 片并行扫描
+pair<double, double> solveBlockSelection(vector<Block>& blocks, int thread_count = 1) {
     if (blocks.empty()) return {0.0, 0.0};
 
     vector<double> Y;
@@ -103,10 +182,8 @@ pair<double, double> solveBlockSelection(vector<Block>& blocks) {
     sort(Y.begin(), Y.end());
     Y.erase(unique(Y.begin(), Y.end()), Y.end());
 
-    int y_cnt = Y.size();
-    // 离散化后的有效区间是 y_cnt - 1 个
+    // 离散化后的有效区间是 Y.size() - 1 个
     // 每一个索引 i 代表区间 [Y[i], Y[i+1])
-    n = y_cnt - 1; 
 
     // 2. 构建事件
     vector<Event> events;
@@ -124,50 +201,111 @@ pair<double, double> solveBlockSelection(vector<Block>& blocks) {
     }
     sort(events.begin(), events.end());
 
-    // 3. 初始化线段树
-    build(1, 0, n - 1);
-
-    double max_weight = -1.0;
-    double best_x1 = 0, best_x2 = 0;
-    double best_y1 = 0, best_y2 = 0;
-
-    // 4. 扫描过程
-    for (int i = 0; i < events.size(); ++i) {
-        // 更新线段树
-        update(1, 0, n - 1, events[i].y_start_idx, events[i].y_end_idx, events[i].type * events[i].weight);
-
-        // 如果下一个事件的 X 坐标不同，说明当前 X 位置的所有重叠情况已处理完毕
-        // 或者是最后一个事件
-        if (i == events.size() - 1 || events[i+1].x > events[i].x) {
-            double current_max = tree[1].max_val;
-            
-            if (current_max > max_weight) {
-                max_weight = current_max;
-                
-                // 记录 X 范围：当前事件 X 到 下一个事件 X
-                best_x1 = events[i].x;
-                // 防止越界读取下一个
-                best_x2 = (i == events.size() - 1) ? best_x1 : events[i+1].x;
-                
-                // 获取 Y 范围：根据线段树最大值所在的索引 idx
-                int best_idx = tree[1].max_idx;
-                best_y1 = Y[best_idx];
-                best_y2 = Y[best_idx + 1];
-            }
-        }
-    }
+    // 3. 扫描并合并各分片
+    Selection best = sweepEvents(events, Y, thread_count);
 
     // 计算中心点 (原算法逻辑)
-    double center_x = (best_x1 + best_x2) / 2.0;
-    double center_y = (best_y1 + best_y2) / 2.0;
+    double center_x = (best.x1 + best.x2) / 2.0;
+    double center_y = (best.y1 + best.y2) / 2.0;
 
-    cout << "最大权重: " << max_weight << endl;
-    cout << "最佳区域 X: [" << best_x1 << ", " << best_x2 << "]" << endl;
-    cout << "最佳区域 Y: [" << best_y1 << ", " << best_y2 << "]" << endl;
+    cout << "最大权重: " << best.max_weight << endl;
+    cout << "最佳区域 X: [" << best.x1 << ", " << best.x2 << "]" << endl;
+    cout << "最佳区域 Y: [" << best.y1 << ", " << best.y2 << "]" << endl;
 
     return {center_x, center_y};
 }
 
+// 待验证 Block 的中心及权重；某个尺寸下它生成的矩形为中心 ± 半边长
+struct Site {
+    double x, y;
+    double weight;
+};
+
+// 矩形尺寸：length 为 X 方向边长，width 为 Y 方向边长，均不小于 0
+struct RectSize {
+    double length, width;
+};
+
+// 一个尺寸的结果，与用该尺寸生成的矩形调用 solveBlockSelection 相同
+struct SizeSelection {
+    RectSize size;
+    Selection best;
+    pair<double, double> center;
+};
+
+// 有序的 values（可重复）各减 half、各加 half 后得到两条有序序列，归并成有序去重的坐标写入 out；
+// low[k]、high[k] 为 values[k] - half、values[k] + half 在 out 中的下标
+void mergeShifted(const vector<double>& values, double half, vector<double>& out, vector<int>& low, vector<int>& high) {
+    size_t count = values.size(), a = 0, b = 0;
+    out.clear();
+    while (a < count || b < count) {
+        bool take_low = b == count || (a < count && values[a] - half <= values[b] + half);
+        double v = take_low ? values[a] - half : values[b] + half;
+        if (out.empty() || out.back() != v) out.push_back(v);
+        if (take_low) low[a++] = static_cast<int>(out.size()) - 1;
+        else high[b++] = static_cast<int>(out.size()) - 1;
+    }
+}
+
+// 一次计算多个尺寸的最优区域，结果依次对应 sizes。
+// 与尺寸无关的工作只做一次：Block 中心按 x、按 y 各排序一次。每个尺寸的离散 Y 坐标由两条平移后的
+// 有序序列归并得到，入边、出边事件也分别按 x 有序，归并即得排好序的事件，不再排序。
+// thread_count > 1 时各尺寸分给不同线程，每个尺寸内部串行扫描。
+vector<SizeSelection> solveBlockSelectionBatch(const vector<Site>& sites, const vector<RectSize>& sizes,
+                                               int thread_count = 1) {
+    vector<SizeSelection> results(sizes.size());
+    if (sites.empty()) return results;
+    const size_t m = sites.size();
+
+    vector<int> by_x(m), by_y(m);
+    for (size_t k = 0; k < m; ++k) by_x[k] = by_y[k] = static_cast<int>(k);
+    sort(by_x.begin(), by_x.end(), [&](int a, int b) { return sites[a].x < sites[b].x; });
+    sort(by_y.begin(), by_y.end(), [&](int a, int b) { return sites[a].y < sites[b].y; });
+    vector<double> sorted_y(m);
+    for (size_t k = 0; k < m; ++k) sorted_y[k] = sites[by_y[k]].y;
+
+    auto solve = [&](size_t s) {
+        const double half_length = sizes[s].length / 2.0;
+        const double half_width = sizes[s].width / 2.0;
+        vector<double> Y;
+        vector<int> low(m), high(m), y_lo(m), y_hi(m);
+        mergeShifted(sorted_y, half_width, Y, low, high);
+        for (size_t k = 0; k < m; ++k) {
+            y_lo[by_y[k]] = low[k];
+            y_hi[by_y[k]] = high[k];
+        }
+
+        // 入边按中心 x 有序，出边也是，两者归并；X 相同时先入边后出边，与 Event::operator< 一致
+        vector<Event> events;
+        events.reserve(2 * m);
+        size_t a = 0, b = 0;
+        while (a < m || b < m) {
+            bool take_enter = b == m || (a < m && sites[by_x[a]].x - half_length <= sites[by_x[b]].x + half_length);
+            int k = take_enter ? by_x[a++] : by_x[b++];
+            if (y_lo[k] >= y_hi[k]) continue;
+            if (take_enter) events.push_back({sites[k].x - half_length, 1, y_lo[k], y_hi[k] - 1, sites[k].weight});
+            else events.push_back({sites[k].x + half_length, -1, y_lo[k], y_hi[k] - 1, sites[k].weight});
+        }
+
+        SizeSelection& r = results[s];
+        r.size = sizes[s];
+        r.best = sweepEvents(events, Y, 1);
+        r.center = {(r.best.x1 + r.best.x2) / 2.0, (r.best.y1 + r.best.y2) / 2.0};
+    };
+
+    if (thread_count > static_cast<int>(sizes.size())) thread_count = static_cast<int>(sizes.size());
+    if (thread_count < 1) thread_count = 1;
+    atomic<size_t> next_size{0};
+    auto run = [&] {
+        for (size_t s; (s = next_size.fetch_add(1)) < sizes.size();) solve(s);
+    };
+    vector<thread> threads;
+    for (int t = 1; t < thread_count; ++t) threads.emplace_back(run);
+    run();
+    for (auto& worker : threads) worker.join();
+    return results;
+}
+
 int main() {
     // 示例数据：生成一些矩形 (x1, y1, x2, y2, weight)
     // 这里的矩形可以理解为：以待验证 Block 为中心生成的区域
@@ -179,9 +317,22 @@ int main() {
     };
 
     cout << "开始计算最佳区块位置..." << endl;
-    pair<double, double> center = solveBlockSelection(blocks);
+    pair<double, double> center = solveBlockSelection(blocks, thread::hardware_concurrency());
 
     cout << "推荐中心点坐标: (" << center.first << ", " << center.second << ")" << endl;
 
+    // 一次计算多个尺寸：以各 Block 的中心和权重为输入，尝试不同的矩形尺寸
+    vector<Site> sites;
+    for (const auto& b : blocks) sites.push_back({(b.x1 + b.x2) / 2.0, (b.y1 + b.y2) / 2.0, b.weight});
+    vector<RectSize> sizes = {{4, 6}, {10, 10}, {20, 20}};
+    vector<SizeSelection> results = solveBlockSelectionBatch(sites, sizes, thread::hardware_concurrency());
+    cout << "\n多个尺寸:" << endl;
+    for (const auto& r : results) {
+        cout << "length = " << r.size.length << ", width = " << r.size.width
+             << ": 最大权重 " << r.best.max_weight
+             << " 区域 [" << r.best.x1 << ", " << r.best.x2 << "] x [" << r.best.y1 << ", " << r.best.y2 << "]"
+             << " 中心 (" << r.center.first << ", " << r.center.second << ")" << endl;
+    }
+
     return 0;
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include "trace.h"
 
 // 定义点结构
 typedef struct {
@@ -7,17 +8,33 @@ typedef struct {
     int y;
 } Point;
 
-// 定义矩形区域结构
+// 覆盖计数的结果：覆盖点数最多的格子及其覆盖数
 typedef struct {
-    int xl; // x-low
-    int yl; // y-low
-    int xh; // x-high
-    int yh; // y-high
-    int xcenter;
-    int ycenter;
     int maxcover;
-    int maxcoverOfp;
-} Rec;
+    int maxj; // 格子的行号（y 方向），没有格子时为 -1
+    int maxi; // 格子的列号（x 方向），没有格子时为 -1
+} CoverResult;
+
+// 一个轴上的候选坐标（有序去重），以及第 k 个点的可行中心区间两端 [coords[lo[k]], coords[hi[k]]]
+typedef struct {
+    const int *coords;
+    int count;
+    const int *lo;
+    const int *hi;
+} CoverAxis;
+
+// 矩形A的一个尺寸
+typedef struct {
+    int length;
+    int width;
+} RectSize;
+
+// 一个尺寸的最优放置：覆盖数、格子行列号，以及格子范围 [xl, xh] x [yl, yh]（没有格子时为 0）
+typedef struct {
+    RectSize size;
+    CoverResult cover;
+    int xl, xh, yl, yh;
+} SizeResult;
 
 // qsort的比较函数
 int compare_int(const void *a, const void *b) {
@@ -38,17 +55,208 @@ int unique_sort(int *arr, int n) {
     return j + 1;
 }
 
-int iscover(Rec r,Point p,int halflength,int halfwidth)
-{
-    if(p.x>=(r.xcenter-halflength)&&p.x<=(r.xcenter+halflength)&&p.y>=(r.ycenter-halfwidth)&&p.y<=(r.ycenter+halfwidth)) return 1;
-    return 0;
+// 有序数组中等于 value 的元素下标（value 一定存在）
+int index_of(const int *arr, int n, int value) {
+    int lo = 0, hi = n - 1;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (arr[mid] < value) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// 一个轴上共 cells 个格子，格子 i 为 [xs[i], xs[i+1]]，中心取 (xs[i] + xs[i+1]) / 2。
+// 中心在 [xs[lo], xs[hi]] 内的格子是连续的一段 [*first, *last]：
+// lo..hi-1 一定在内，lo-1 和 hi 只有中心恰好落在端点上时才在内（可能为空，即 *first > *last）
+void center_range(const int *xs, int cells, int lo, int hi, int *first, int *last) {
+    *first = lo;
+    if (lo >= 1 && (xs[lo - 1] + xs[lo]) / 2 == xs[lo]) *first = lo - 1;
+    *last = hi - 1;
+    if (hi < cells && (xs[hi] + xs[hi + 1]) / 2 == xs[hi]) *last = hi;
+}
+
+// 二维差分：矩形 [x0, x1] x [y0, y1] 内全部加 1
+void diff_add(int *diff, size_t stride, int x0, int x1, int y0, int y1) {
+    if (x0 > x1 || y0 > y1) return;
+    diff[y0 * stride + x0]++;
+    diff[y0 * stride + x1 + 1]--;
+    diff[(y1 + 1) * stride + x0]--;
+    diff[(y1 + 1) * stride + x1 + 1]++;
+}
+
+// 二维前缀和，把差分还原成每个格子的计数
+void prefix_sum_2d(int *grid, int rows, int cols, size_t stride) {
+    for (int j = 0; j < rows; j++) {
+        int *row = grid + j * stride;
+        const int *above = j > 0 ? row - stride : NULL;
+        for (int i = 0; i < cols; i++) {
+            if (i > 0) row[i] += row[i - 1];
+            if (above != NULL) row[i] += above[i] - (i > 0 ? above[i - 1] : 0);
+        }
+    }
 }
-int iscoverOfp(int px,int py,Point p,int halflength,int halfwidth)
-{
-    if(p.x>=(px-halflength)&&p.x<=(px+halflength)&&p.y>=(py-halfwidth)&&p.y<=(py+halfwidth)) return 1;
+
+// 格子由候选坐标划分，第 j 行第 i 列为 [xs[i], xs[i+1]] x [ys[j], ys[j+1]]（xs、ys 即两个轴的 coords）。
+// 对每个格子统计两个数：矩形A中心放在格子中心 ((xl+xh)/2, (yl+yh)/2) 时覆盖的点数 (cover)，
+// 以及中心放在格子左下角 (xl, yl) 时覆盖的点数 (coverOfp)；按行、列顺序找最大值，先比 cover 再比 coverOfp，
+// 只有严格更大才更新。
+// 点 p 被中心 (cx, cy) 的矩形覆盖，当且仅当 cx 在 [p.x-半长, p.x+半长]、cy 在 [p.y-半宽, p.y+半宽] 内，
+// 这两个端点都是候选坐标；所以每个点在两张表上各对应一个轴对齐的格子范围，用二维差分数组放入，
+// 前缀和一次后逐格扫描。总代价 O(N + U^2)，表在堆上按行连续存放。
+// trace_cells 非 0 时逐格输出跟踪信息。返回 0 表示成功，内存不足时返回 1。
+int max_cover_axes(const CoverAxis *x, const CoverAxis *y, int num_points, int trace_cells, CoverResult *result) {
+    const int *xs = x->coords, *ys = y->coords;
+    result->maxcover = 0;
+    result->maxj = -1;
+    result->maxi = -1;
+    int cells_x = x->count - 1, cells_y = y->count - 1;
+    if (cells_x <= 0 || cells_y <= 0) return 0;
+
+    size_t stride = (size_t)cells_x + 1;
+    size_t grid_size = stride * ((size_t)cells_y + 1);
+    int *center = calloc(2 * grid_size, sizeof(int)); // 中心表与左下角表连在一起
+    if (center == NULL) return 1;
+    int *corner = center + grid_size;
+
+    for (int k = 0; k < num_points; k++) {
+        int x_lo = x->lo[k], x_hi = x->hi[k];
+        int y_lo = y->lo[k], y_hi = y->hi[k];
+
+        int x_first, x_last, y_first, y_last;
+        center_range(xs, cells_x, x_lo, x_hi, &x_first, &x_last);
+        center_range(ys, cells_y, y_lo, y_hi, &y_first, &y_last);
+        diff_add(center, stride, x_first, x_last, y_first, y_last);
+
+        // 左下角 (xs[i], ys[j]) 在范围内当且仅当 lo <= i <= hi
+        diff_add(corner, stride, x_lo, x_hi < cells_x ? x_hi : cells_x - 1,
+                 y_lo, y_hi < cells_y ? y_hi : cells_y - 1);
+    }
+    prefix_sum_2d(center, cells_y, cells_x, stride);
+    prefix_sum_2d(corner, cells_y, cells_x, stride);
+
+    for (int j = 0; j < cells_y; j++) {
+        for (int i = 0; i < cells_x; i++) {
+            int cover = center[j * stride + i];
+            int coverOfp = corner[j * stride + i];
+            //test
+            if (trace_cells) {
+                TRACE("j=%d i=%d xcenter=%d ycenter=%d cover=%d\n", j, i, (xs[i] + xs[i + 1]) / 2,
+                      (ys[j] + ys[j + 1]) / 2, cover);
+            }
+
+            if (cover > result->maxcover) {
+                result->maxi = i;
+                result->maxj = j;
+                result->maxcover = cover;
+            }
+            if (coverOfp > result->maxcover) {
+                result->maxi = i;
+                result->maxj = j;
+                result->maxcover = coverOfp;
+            }
+        }
+    }
+    free(center);
     return 0;
 }
 
+// 候选坐标 xs（num_x 个）、ys（num_y 个）已去重排序：用二分查找定位每个点的区间两端后交给 max_cover_axes。
+// 返回 0 表示成功，内存不足时返回 1。
+int max_cover_grid(const Point *points, int num_points, const int *xs, int num_x, const int *ys, int num_y,
+                   int half_length, int half_width, CoverResult *result) {
+    int *ends = malloc(4 * (size_t)(num_points > 0 ? num_points : 1) * sizeof(int));
+    if (ends == NULL) return 1;
+    int *x_lo = ends, *x_hi = ends + num_points, *y_lo = ends + 2 * num_points, *y_hi = ends + 3 * num_points;
+    for (int k = 0; k < num_points; k++) {
+        x_lo[k] = index_of(xs, num_x, points[k].x - half_length);
+        x_hi[k] = index_of(xs, num_x, points[k].x + half_length);
+        y_lo[k] = index_of(ys, num_y, points[k].y - half_width);
+        y_hi[k] = index_of(ys, num_y, points[k].y + half_width);
+    }
+    CoverAxis x = {xs, num_x, x_lo, x_hi};
+    CoverAxis y = {ys, num_y, y_lo, y_hi};
+    int status = max_cover_axes(&x, &y, num_points, 1, result);
+    free(ends);
+    return status;
+}
+
+// 有序去重的 values 各减 half、各加 half 后得到两条有序序列，一次归并成有序去重的候选坐标写入 out，返回个数。
+// low[k]、high[k] 为 values[k] - half、values[k] + half 在 out 中的下标。
+int merge_candidates(const int *values, int count, int half, int *out, int *low, int *high) {
+    int a = 0, b = 0, n = 0;
+    while (a < count || b < count) {
+        int take_low = b == count || (a < count && values[a] - half <= values[b] + half);
+        int v = take_low ? values[a] - half : values[b] + half;
+        if (n == 0 || out[n - 1] != v) out[n++] = v;
+        if (take_low) low[a++] = n - 1;
+        else high[b++] = n - 1;
+    }
+    return n;
+}
+
+// 点坐标去重排序后的结果，以及每个点的坐标在其中的下标；与矩形尺寸无关
+void rank_coordinates(const int *coords, int num_points, int *sorted, int *count, int *rank) {
+    for (int k = 0; k < num_points; k++) sorted[k] = coords[k];
+    *count = unique_sort(sorted, num_points);
+    for (int k = 0; k < num_points; k++) rank[k] = index_of(sorted, *count, coords[k]);
+}
+
+// 一次计算多个尺寸的最优放置，results[s] 对应 sizes[s]，每个尺寸的结果与单独计算相同。
+// 与尺寸无关的工作只做一次：点的 x、y 各排序去重一次并记下每个点的名次。
+// 每个尺寸的候选坐标由两条平移后的有序序列归并得到（不再排序），点的区间两端直接由名次查出（不再二分查找）。
+// 不逐格跟踪，每个尺寸只输出一行结果。返回 0 表示成功，内存不足时返回 1。
+int max_cover_batch(const Point *points, int num_points, const RectSize *sizes, int num_sizes, SizeResult *results) {
+    size_t n = (size_t)(num_points > 0 ? num_points : 1);
+    // 依次为：点的 x、y 坐标，去重排序后的 x、y，点的名次 (x, y)，候选 x、y，
+    // 每个去重坐标的区间两端下标 (x 低/高, y 低/高)，每个点的区间两端下标 (x 低/高, y 低/高)
+    int *buffer = malloc(18 * n * sizeof(int));
+    if (buffer == NULL) return 1;
+    int *px = buffer, *py = px + n, *ux = py + n, *uy = ux + n, *rank_x = uy + n, *rank_y = rank_x + n;
+    int *cx = rank_y + n, *cy = cx + 2 * n;
+    int *ux_low = cy + 2 * n, *ux_high = ux_low + n, *uy_low = ux_high + n, *uy_high = uy_low + n;
+    int *x_lo = uy_high + n, *x_hi = x_lo + n, *y_lo = x_hi + n, *y_hi = y_lo + n;
+
+    for (int k = 0; k < num_points; k++) {
+        px[k] = points[k].x;
+        py[k] = points[k].y;
+    }
+    int num_ux, num_uy;
+    rank_coordinates(px, num_points, ux, &num_ux, rank_x);
+    rank_coordinates(py, num_points, uy, &num_uy, rank_y);
+
+    int status = 0;
+    for (int s = 0; s < num_sizes && status == 0; s++) {
+        int half_length = sizes[s].length / 2;
+        int half_width = sizes[s].width / 2;
+        int num_x = merge_candidates(ux, num_ux, half_length, cx, ux_low, ux_high);
+        int num_y = merge_candidates(uy, num_uy, half_width, cy, uy_low, uy_high);
+        for (int k = 0; k < num_points; k++) {
+            x_lo[k] = ux_low[rank_x[k]];
+            x_hi[k] = ux_high[rank_x[k]];
+            y_lo[k] = uy_low[rank_y[k]];
+            y_hi[k] = uy_high[rank_y[k]];
+        }
+        CoverAxis x = {cx, num_x, x_lo, x_hi};
+        CoverAxis y = {cy, num_y, y_lo, y_hi};
+
+        SizeResult *r = &results[s];
+        r->size = sizes[s];
+        status = max_cover_axes(&x, &y, num_points, 0, &r->cover);
+        r->xl = r->xh = r->yl = r->yh = 0;
+        if (r->cover.maxi >= 0) {
+            r->xl = cx[r->cover.maxi];
+            r->xh = cx[r->cover.maxi + 1];
+            r->yl = cy[r->cover.maxj];
+            r->yh = cy[r->cover.maxj + 1];
+        }
+        TRACE("size=%dx%d cells=%dx%d cover=%d\n", r->size.length, r->size.width, num_x - 1, num_y - 1,
+              r->cover.maxcover);
+    }
+    free(buffer);
+    return status;
+}
+
 int main() {
     // 输入案例
     Point points[] = {{2, 2},{2,4},{6,4},{6,6},{4, 6}};
@@ -89,68 +297,44 @@ int main() {
     //test
     for(int i=0;i<num_unique_x;i++)
     {
-        printf("x=%d ",candidate_x[i]);
+        TRACE("x=%d ",candidate_x[i]);
     }
-    printf("\n");
+    TRACE("\n");
     for(int i=0;i<num_unique_y;i++)
     {
-        printf("y=%d ",candidate_y[i]);
+        TRACE("y=%d ",candidate_y[i]);
     }
-    printf("\n");
-
+    TRACE("\n");
 
 
-    Rec rect[num_unique_y-1][num_unique_x-1];//从左往右，从下到上。
-    int maxcover=0;
-    int maxiOfrec=-1;
-    int maxjOfrec=-1;
-    for(int j=0;j<num_unique_y-1;j++)
-    {
-        for(int i=0;i<num_unique_x-1;i++)
-         {
-            rect[j][i].xl=candidate_x[i];
-            rect[j][i].xh=candidate_x[i+1];
-            rect[j][i].yl=candidate_y[j];
-            rect[j][i].yh=candidate_y[j+1];
-            rect[j][i].maxcover=0;
-            rect[j][i].maxcoverOfp=0;
-            rect[j][i].xcenter=(rect[j][i].xl+rect[j][i].xh)/2;
-            rect[j][i].ycenter=(rect[j][i].yl+rect[j][i].yh)/2;
-            for(int k=0;k<num_points;k++)
-            {
-                if(iscover(rect[j][i],points[k],half_length,half_width)==1) 
-                {
-                    rect[j][i].maxcover++;
-                }
-                if(iscoverOfp(rect[j][i].xl,rect[j][i].yl,points[k],half_length,half_width)==1)
-                {
-                    rect[j][i].maxcoverOfp++;
-                }
-            }
-            //test
-            printf("j=%d i=%d xcenter=%d ycenter=%d cover=%d\n",j,i,rect[j][i].xcenter,rect[j][i].ycenter,rect[j][i].maxcover);
-
-            if(rect[j][i].maxcover>maxcover)
-            {
-                maxiOfrec=i;
-                maxjOfrec=j;
-                maxcover=rect[j][i].maxcover;
-            }
-            if(rect[j][i].maxcoverOfp>maxcover)
-            {
-                maxiOfrec=i;
-                maxjOfrec=j;
-                maxcover=rect[j][i].maxcoverOfp;
-            }
 
+    CoverResult best;
+    if (max_cover_grid(points, num_points, candidate_x, num_unique_x, candidate_y, num_unique_y,
+                       half_length, half_width, &best) != 0) {
+        printf("内存分配失败\n");
+        return 1;
+    }
 
-            
+     //test
+            printf("maxcover=%d j=%d i=%d \n",best.maxcover,best.maxj,best.maxi);
 
-         }
+    // 一次计算多个矩形A尺寸
+    RectSize sizes[] = {{2, 2}, {2, 4}, {4, 2}, {4, 4}};
+    int num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+    SizeResult results[sizeof(sizes) / sizeof(sizes[0])];
+    if (max_cover_batch(points, num_points, sizes, num_sizes, results) != 0) {
+        printf("内存分配失败\n");
+        return 1;
+    }
+    printf("\n多个尺寸:\n");
+    for (int s = 0; s < num_sizes; s++) {
+        printf("length = %d, width = %d: maxcover=%d j=%d i=%d 格子 [%d, %d] x [%d, %d]\n",
+               results[s].size.length, results[s].size.width, results[s].cover.maxcover,
+               results[s].cover.maxj, results[s].cover.maxi,
+               results[s].xl, results[s].xh, results[s].yl, results[s].yh);
     }
 
-     //test
-            printf("maxcover=%d j=%d i=%d \n",maxcover,maxjOfrec,maxiOfrec);
+    TRACE_DUMP("algorithm3.trace");
 
  
     
@@ -0,0 +1,105 @@
+// 共线密集输入上的可见网络构建耗时：串行扫描与分片并行构建各测一次，
+// 并检查分片并行构建的边集合及加入顺序与串行扫描相同，不同时返回 1
+// 编译: gcc -O2 -pthread benchmark_collinear.c -lm
+// 运行: ./a.out [重复次数] [线程数]，线程数默认取在线 CPU 数
+#define TRACE_LEVEL 0
+#define main algorithm1_main
+#include "algorithm1.c"
+#undef main
+#include <time.h>
+
+double now_seconds(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+// 退化输入：
+//   0 正方形整数网格 side x side（大量横、竖、斜向共线）
+//   1 只有 8 行的宽网格（相同费率档位）
+//   2 只有 8 列的高网格（相同时间戳）
+//   3 一条斜线上的点加少量随机点
+void make_points(int kind, int side, Point *points, int n) {
+    srand(1);
+    for (int i = 0; i < n; i++) {
+        switch (kind) {
+        case 0: points[i] = (Point){i % side, i / side, 0}; break;
+        case 1: points[i] = (Point){i / 8, i % 8, 0}; break;
+        case 2: points[i] = (Point){i % 8, i / 8, 0}; break;
+        default:
+            if (i % 16 == 0) points[i] = (Point){rand() % n, rand() % n, 0};
+            else points[i] = (Point){i, i, 0};
+            break;
+        }
+    }
+    // 第 3 种里随机点可能与斜线上的点重合，去掉重复
+    if (kind == 3) {
+        for (int i = 0; i < n; i++) {
+            if (i % 16 == 0 && points[i].x == points[i].y) points[i].y = points[i].x + 1;
+        }
+    }
+}
+
+// 用 build(points, n, E, thread_count) 构建 repeat 次，返回最短耗时，最后一次的边集合留在 E 中
+double time_build(void (*build)(Point *, int, EdgeSet *, int), int kind, int side, Point *points, int n,
+                  int thread_count, int repeat, EdgeSet *E) {
+    double best = 1e30;
+    for (int r = 0; r < repeat; r++) {
+        make_points(kind, side, points, n);
+        if (r > 0) edge_set_free(E);
+        double start = now_seconds();
+        build(points, n, E, thread_count);
+        double elapsed = now_seconds() - start;
+        if (elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+void build_sequential(Point *points, int n, EdgeSet *E, int thread_count) {
+    (void)thread_count;
+    build_visible_network(points, n, E);
+}
+
+bool same_edges(const EdgeSet *a, const EdgeSet *b) {
+    return a->count == b->count && memcmp(a->edges, b->edges, a->count * sizeof(uint64_t)) == 0;
+}
+
+// 线程数少时（如单核机器）分片构建会退回串行扫描，核对时至少分这么多片，保证分片合并被覆盖
+#define CHECK_SLAB_COUNT 4
+
+int main(int argc, char **argv) {
+    const char *names[] = {"正方形网格", "8 行宽网格", "8 列高网格", "斜线+随机点"};
+    int sides[] = {50, 100, 200};
+    int repeat = argc > 1 ? atoi(argv[1]) : 3;
+    int thread_count = argc > 2 ? atoi(argv[2]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (repeat < 1) repeat = 1;
+    if (thread_count < 1) thread_count = 1;
+
+    printf("线程数 = %d\n", thread_count);
+    int mismatches = 0;
+    for (int kind = 0; kind < 4; kind++) {
+        for (int s = 0; s < 3; s++) {
+            int n = sides[s] * sides[s];
+            Point *points = malloc(n * sizeof(Point));
+            EdgeSet serial, slabs;
+            double serial_time = time_build(build_sequential, kind, sides[s], points, n, 1, repeat, &serial);
+            double slab_time = time_build(build_visible_network_slabs, kind, sides[s], points, n,
+                                          thread_count, repeat, &slabs);
+            bool same = same_edges(&serial, &slabs);
+            if (same && thread_count < CHECK_SLAB_COUNT) {
+                EdgeSet check;
+                make_points(kind, sides[s], points, n);
+                build_visible_network_slabs(points, n, &check, CHECK_SLAB_COUNT);
+                same = same_edges(&serial, &check);
+                edge_set_free(&check);
+            }
+            if (!same) mismatches++;
+            printf("%s\tn = %6d  边数 = %8d  串行 %.4f s  分片并行 %.4f s  %s\n",
+                   names[kind], n, serial.count, serial_time, slab_time, same ? "✓" : "✗ 与串行结果不同");
+            edge_set_free(&serial);
+            edge_set_free(&slabs);
+            free(points);
+        }
+    }
+    return mismatches > 0;
+}
@@ -0,0 +1,134 @@
+// 流式引擎快照的往返检查：扫描到一半时 engine_save，丢弃引擎后 engine_restore 继续插入，
+// 回调收到的边序列（含保存前的部分）必须与不中断的扫描完全相同。全部一致返回 0，否则返回 1。
+// 编译: gcc -O2 -pthread test_engine_snapshot.c -lm
+#define TRACE_LEVEL 0
+#define main algorithm1_main
+#include "algorithm1.c"
+#undef main
+
+// 回调收到的边，按到达顺序每条两个 id
+typedef struct {
+    int *ids;
+    int count;
+    int capacity;
+} EdgeLog;
+
+void log_edge(void *context, int id1, int id2) {
+    EdgeLog *log = context;
+    if (log->count + 2 > log->capacity) {
+        log->capacity = log->capacity * 2 + 16;
+        log->ids = realloc(log->ids, log->capacity * sizeof(int));
+    }
+    log->ids[log->count++] = id1;
+    log->ids[log->count++] = id2;
+}
+
+// 退化输入：0 正方形网格，1 只有 3 行的宽网格，2 小范围内的随机点（大量共线与重合坐标被去重）
+int make_points(int kind, int n, Point *points) {
+    int count = 0;
+    srand(7 + kind);
+    for (int i = 0; i < n; i++) {
+        Point p;
+        switch (kind) {
+        case 0: p = (Point){i % 12, i / 12, 0}; break;
+        case 1: p = (Point){i / 3, i % 3, 0}; break;
+        default: p = (Point){rand() % 20, rand() % 20, 0}; break;
+        }
+        points[count++] = p;
+    }
+    qsort(points, count, sizeof(Point), compare_points);
+    int unique = 0;
+    for (int i = 0; i < count; i++) {
+        if (unique > 0 && points[unique - 1].x == points[i].x && points[unique - 1].y == points[i].y) continue;
+        points[unique] = points[i];
+        points[unique].id = unique + 1;
+        unique++;
+    }
+    return unique;
+}
+
+// 从右向左插入 points[from, to)（扫描顺序），返回是否全部被接受
+bool insert_range(VisibleNetworkEngine *engine, const Point *points, int n, int from, int to) {
+    for (int i = from; i < to; i++) {
+        if (!engine_insert(engine, points[n - 1 - i])) return false;
+    }
+    return true;
+}
+
+// 不中断地扫描，记录回调序列；expected_count 故意偏小，让恢复后的插入越过快照中数组的容量
+void run_straight(const Point *points, int n, EdgeLog *log) {
+    VisibleNetworkEngine engine;
+    engine_init(&engine, bounding_box(points, n), n / 4, log_edge, log, NULL);
+    insert_range(&engine, points, n, 0, n);
+    engine_free(&engine);
+}
+
+// 插入前 cut 个点后保存快照，释放引擎，从快照恢复后插入其余的点
+bool run_with_snapshot(const Point *points, int n, int cut, const char *path, EdgeLog *log) {
+    VisibleNetworkEngine engine;
+    engine_init(&engine, bounding_box(points, n), n / 4, log_edge, log, NULL);
+    insert_range(&engine, points, n, 0, cut);
+    bool saved = engine_save(&engine, path);
+    engine_free(&engine);
+    if (!saved) return false;
+
+    VisibleNetworkEngine restored;
+    if (!engine_restore(&restored, path, log_edge, log, NULL)) return false;
+    bool ok = restored.V_count == cut && insert_range(&restored, points, n, cut, n);
+    engine_free(&restored);
+    return ok;
+}
+
+int main(void) {
+    const char *names[] = {"正方形网格", "3 行宽网格", "随机点"};
+    char path[] = "/tmp/engine_snapshot_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    close(fd);
+
+    int failures = 0;
+    for (int kind = 0; kind < 3; kind++) {
+        int n_max = 300;
+        Point *points = malloc(n_max * sizeof(Point));
+        int n = make_points(kind, n_max, points);
+        EdgeLog expected = {NULL, 0, 0};
+        run_straight(points, n, &expected);
+
+        int cuts[] = {0, 1, 2, 3, 4, n / 3, n / 2, n - 1, n};
+        int checked = 0, wrong = 0;
+        for (size_t c = 0; c < sizeof(cuts) / sizeof(cuts[0]); c++) {
+            EdgeLog got = {NULL, 0, 0};
+            bool ok = run_with_snapshot(points, n, cuts[c], path, &got) && got.count == expected.count &&
+                      memcmp(got.ids, expected.ids, expected.count * sizeof(int)) == 0;
+            if (!ok) {
+                printf("%s: 在第 %d 个点后保存时回调序列不同\n", names[kind], cuts[c]);
+                wrong++;
+            }
+            checked++;
+            free(got.ids);
+        }
+        printf("%s\tn = %d  边数 = %d  %d 个保存点 %s\n", names[kind], n, expected.count / 2, checked,
+               wrong == 0 ? "✓" : "✗");
+        failures += wrong;
+        free(expected.ids);
+        free(points);
+    }
+
+    // 损坏或不存在的快照必须被拒绝
+    FILE *file = fopen(path, "r+b");
+    if (file != NULL) {
+        fputc('X', file);
+        fclose(file);
+    }
+    VisibleNetworkEngine engine;
+    bool rejected = !engine_restore(&engine, path, NULL, NULL, NULL);
+    unlink(path);
+    rejected = rejected && !engine_restore(&engine, path, NULL, NULL, NULL);
+    printf("拒绝损坏或不存在的快照 %s\n", rejected ? "✓" : "✗");
+    if (!rejected) failures++;
+
+    return failures > 0;
+}
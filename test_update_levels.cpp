@@ -0,0 +1,116 @@
+// update_levels 的增量结果检查：在随机可见图上反复施加 GraphDelta（加/删事务、加/删边），
+// 每一步把增量更新后的 H_1..H_k 与按新图从头 build_levels 的结果逐个簇比较。全部一致返回 0，否则返回 1。
+// 编译: g++ -std=c++17 -O2 -pthread test_update_levels.cpp
+#define TRACE_LEVEL 0
+#define main algorithm2_main
+#include "algorithm2.cpp"
+#undef main
+#include <random>
+
+/**
+ * @brief 按 GraphDelta 的应用顺序（删边 -> 删点 -> 加点 -> 加边）更新参照用的邻接表
+ */
+void apply_to_adjacency(std::map<int, std::set<int>>& adj, const GraphDelta& delta) {
+    for (const auto& e : delta.removed_edges) {
+        if (adj.count(e.first) && adj.count(e.second)) {
+            adj[e.first].erase(e.second);
+            adj[e.second].erase(e.first);
+        }
+    }
+    for (int id : delta.removed_nodes) {
+        if (!adj.count(id)) continue;
+        for (int v : adj[id]) adj[v].erase(id);
+        adj.erase(id);
+    }
+    for (int id : delta.added_nodes) {
+        if (id >= 1) adj[id];
+    }
+    for (const auto& e : delta.added_edges) {
+        if (e.first != e.second && adj.count(e.first) && adj.count(e.second)) {
+            adj[e.first].insert(e.second);
+            adj[e.second].insert(e.first);
+        }
+    }
+}
+
+/**
+ * @brief 随机生成一次变化：删边、删点、加点（带几条边）或只加边，id 可以超出当前范围
+ */
+GraphDelta random_delta(std::mt19937& rng, const std::map<int, std::set<int>>& adj, int n) {
+    GraphDelta delta;
+    const int kind = rng() % 4;
+    const int count = 1 + rng() % 3;
+    for (int c = 0; c < count; ++c) {
+        int a = 1 + rng() % (n + 2), b = 1 + rng() % (n + 2);
+        switch (kind) {
+            case 0:
+                delta.added_edges.push_back({a, b});
+                break;
+            case 1:
+                delta.removed_edges.push_back({a, b});
+                if (adj.count(a) && !adj.at(a).empty()) delta.removed_edges.push_back({a, *adj.at(a).begin()});
+                break;
+            case 2:
+                delta.removed_nodes.push_back(a);
+                break;
+            default: {
+                int id = rng() % 2 ? n + 1 + static_cast<int>(rng() % 3) : a;
+                delta.added_nodes.push_back(id);
+                for (int e = 0; e < 3; ++e) delta.added_edges.push_back({id, 1 + static_cast<int>(rng() % (n + 1))});
+                break;
+            }
+        }
+    }
+    return delta;
+}
+
+int main() {
+    std::mt19937 rng(2024);
+    std::streambuf* console = std::cout.rdbuf(nullptr);    // build_levels 的过程输出不需要
+    int failures = 0;
+    long steps = 0;
+    for (int trial = 0; trial < 120; ++trial) {
+        const int n = 5 + rng() % 40, k = 2 + rng() % 3, l = 1 + rng() % 2;
+        const double p = l == 1 ? 0.25 : 0.06;
+        std::map<int, std::set<int>> adj;
+        for (int i = 1; i <= n; ++i) adj[i];
+        for (int a = 1; a <= n; ++a) {
+            for (int b = a + 1; b <= n; ++b) {
+                if ((rng() % 1000) / 1000.0 < p) {
+                    adj[a].insert(b);
+                    adj[b].insert(a);
+                }
+            }
+        }
+
+        std::vector<ClusterLevel> H;
+        for (int j = 0; j <= k; ++j) H.emplace_back(j);
+        NeighborhoodIndex index(adj, n);
+        build_levels(H, k, l, n, index);
+
+        for (int step = 0; step < 8; ++step, ++steps) {
+            GraphDelta delta = random_delta(rng, adj, index.size());
+            apply_to_adjacency(adj, delta);
+            update_levels(H, k, l, index, delta);
+
+            const int size = index.size();
+            std::vector<ClusterLevel> rebuilt;
+            for (int j = 0; j <= k; ++j) rebuilt.emplace_back(j);
+            NeighborhoodIndex fresh(adj, size);
+            build_levels(rebuilt, k, l, size, fresh);
+            for (int j = 1; j <= k; ++j) {
+                if (H[j].ids() != rebuilt[j].ids()) {
+                    std::cout.rdbuf(console);
+                    std::cout << "第 " << trial << " 组第 " << step << " 步 (k=" << k << ", l=" << l << "): H_" << j
+                              << " 增量 " << H[j].size() << " 个簇，重建 " << rebuilt[j].size() << " 个簇" << std::endl;
+                    std::cout.rdbuf(nullptr);
+                    ++failures;
+                    break;
+                }
+            }
+        }
+    }
+    std::cout.rdbuf(console);
+    std::cout << steps << " 次增量更新与重建比较 " << (failures == 0 ? "✓" : "✗") << std::endl;
+    return failures > 0;
+}
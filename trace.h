@@ -0,0 +1,136 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// 调试跟踪 - 三个算法共用
+// 编译期级别 TRACE_LEVEL（-DTRACE_LEVEL=n）：
+//   0 (TRACE_LEVEL_OFF)    跟踪语句全部编译掉，参数也不求值；定义了 NDEBUG 时的默认值
+//   1 (TRACE_LEVEL_TEXT)   直接打印到 stdout（原来的中间过程输出）；默认值
+//   2 (TRACE_LEVEL_BINARY) 把事件以二进制形式写入内存环形缓冲区，不做格式化也不阻塞 stdout，
+//                          程序结束时 TRACE_DUMP 写成文件，再用 trace_decode 离线解码
+// 用法：
+//   TRACE(fmt, ...)        文本级别打印，二进制级别记录；参数只能是 int（最多 6 个）
+//   TRACE_EVENT(fmt, ...)  只在二进制级别记录，用于文本输出另有写法的地方
+//   if (TRACE_TEXT_ENABLED) { ... }   只在文本级别执行的打印代码（C++ 中用 if constexpr）
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#define TRACE_LEVEL_OFF    0
+#define TRACE_LEVEL_TEXT   1
+#define TRACE_LEVEL_BINARY 2
+
+#ifndef TRACE_LEVEL
+#ifdef NDEBUG
+#define TRACE_LEVEL TRACE_LEVEL_OFF
+#else
+#define TRACE_LEVEL TRACE_LEVEL_TEXT
+#endif
+#endif
+
+#define TRACE_TEXT_ENABLED   (TRACE_LEVEL == TRACE_LEVEL_TEXT)
+#define TRACE_BINARY_ENABLED (TRACE_LEVEL == TRACE_LEVEL_BINARY)
+
+#define TRACE_MAX_ARGS 6
+#define TRACE_FILE_MAGIC "TRC1"
+
+// 文件格式（小端）：
+//   "TRC1" | uint32 格式串个数 | 每个格式串: uint32 长度 + 字节
+//   uint32 事件个数 | 每个事件: uint32 格式串下标, uint32 参数个数, int32 参数[6]
+typedef struct {
+    uint32_t format_index;
+    uint32_t argc;
+    int32_t args[TRACE_MAX_ARGS];
+} TraceRecord;
+
+#if TRACE_BINARY_ENABLED
+
+#ifndef TRACE_RING_CAPACITY
+#define TRACE_RING_CAPACITY (1 << 16)   // 保留最近的事件数，必须是 2 的幂
+#endif
+
+typedef struct {
+    const char *format;
+    int argc;
+    int args[TRACE_MAX_ARGS];
+} TraceEvent;
+
+static TraceEvent trace_ring[TRACE_RING_CAPACITY];
+static uint64_t trace_total = 0;        // 累计记录的事件数，超过容量后覆盖最旧的
+
+static inline void trace_record(const char *format, const int *args, int argc) {
+    TraceEvent *event = &trace_ring[trace_total & (TRACE_RING_CAPACITY - 1)];
+    event->format = format;
+    event->argc = argc < TRACE_MAX_ARGS ? argc : TRACE_MAX_ARGS;
+    for (int i = 0; i < event->argc; i++) event->args[i] = args[i];
+    trace_total++;
+}
+
+// 写出环形缓冲区中保留的事件，格式串按首次出现的顺序编号
+static inline int trace_dump(const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) return -1;
+
+    uint64_t first = trace_total > TRACE_RING_CAPACITY ? trace_total - TRACE_RING_CAPACITY : 0;
+    uint32_t event_count = (uint32_t)(trace_total - first);
+    static const char *formats[TRACE_RING_CAPACITY];
+    static uint32_t indices[TRACE_RING_CAPACITY];
+    uint32_t format_count = 0;
+    for (uint32_t e = 0; e < event_count; e++) {
+        const char *format = trace_ring[(first + e) & (TRACE_RING_CAPACITY - 1)].format;
+        uint32_t k = 0;
+        while (k < format_count && formats[k] != format) k++;
+        if (k == format_count) formats[format_count++] = format;
+        indices[e] = k;
+    }
+
+    fwrite(TRACE_FILE_MAGIC, 1, 4, file);
+    fwrite(&format_count, sizeof(format_count), 1, file);
+    for (uint32_t k = 0; k < format_count; k++) {
+        uint32_t length = (uint32_t)strlen(formats[k]);
+        fwrite(&length, sizeof(length), 1, file);
+        fwrite(formats[k], 1, length, file);
+    }
+    fwrite(&event_count, sizeof(event_count), 1, file);
+    for (uint32_t e = 0; e < event_count; e++) {
+        const TraceEvent *event = &trace_ring[(first + e) & (TRACE_RING_CAPACITY - 1)];
+        TraceRecord record = {indices[e], (uint32_t)event->argc, {0, 0, 0, 0, 0, 0}};
+        for (int i = 0; i < event->argc; i++) record.args[i] = event->args[i];
+        fwrite(&record, sizeof(record), 1, file);
+    }
+    fclose(file);
+    return 0;
+}
+
+#ifdef __cplusplus
+template <typename... Args>
+inline void trace_event(const char *format, Args... args) {
+    const int values[] = {0, static_cast<int>(args)...};
+    trace_record(format, values + 1, static_cast<int>(sizeof...(Args)));
+}
+#define TRACE_EVENT(...) trace_event(__VA_ARGS__)
+#else
+#define TRACE_ARGS(...) ((const int[]){0, ##__VA_ARGS__})
+#define TRACE_EVENT(format, ...) \
+    trace_record(format, TRACE_ARGS(__VA_ARGS__) + 1, \
+                 (int)(sizeof(TRACE_ARGS(__VA_ARGS__)) / sizeof(int)) - 1)
+#endif
+
+#define TRACE(...) TRACE_EVENT(__VA_ARGS__)
+#define TRACE_DUMP(path) trace_dump(path)
+
+#elif TRACE_TEXT_ENABLED
+
+#define TRACE(...) printf(__VA_ARGS__)
+#define TRACE_EVENT(...) ((void)0)
+#define TRACE_DUMP(path) ((void)0)
+
+#else
+
+#define TRACE(...) ((void)0)
+#define TRACE_EVENT(...) ((void)0)
+#define TRACE_DUMP(path) ((void)0)
+
+#endif
+
+#endif
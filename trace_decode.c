@@ -0,0 +1,48 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "trace.h"
+
+// 离线解码 TRACE_LEVEL=2 时 TRACE_DUMP 写出的二进制跟踪文件
+// 用法: trace_decode <文件>
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        printf("用法: %s <跟踪文件>\n", argv[0]);
+        return 1;
+    }
+    FILE *file = fopen(argv[1], "rb");
+    if (file == NULL) {
+        printf("无法打开 %s\n", argv[1]);
+        return 1;
+    }
+
+    char magic[4];
+    uint32_t format_count = 0;
+    if (fread(magic, 1, 4, file) != 4 || memcmp(magic, TRACE_FILE_MAGIC, 4) != 0 ||
+        fread(&format_count, sizeof(format_count), 1, file) != 1) {
+        printf("%s 不是跟踪文件\n", argv[1]);
+        fclose(file);
+        return 1;
+    }
+
+    char **formats = malloc(format_count * sizeof(char *));
+    for (uint32_t k = 0; k < format_count; k++) {
+        uint32_t length = 0;
+        if (fread(&length, sizeof(length), 1, file) != 1) length = 0;
+        formats[k] = malloc(length + 1);
+        formats[k][fread(formats[k], 1, length, file)] = '\0';
+    }
+
+    uint32_t event_count = 0;
+    if (fread(&event_count, sizeof(event_count), 1, file) != 1) event_count = 0;
+    TraceRecord record;
+    for (uint32_t e = 0; e < event_count && fread(&record, sizeof(record), 1, file) == 1; e++) {
+        if (record.format_index >= format_count) break;
+        printf(formats[record.format_index], record.args[0], record.args[1], record.args[2], record.args[3],
+               record.args[4], record.args[5]);
+    }
+
+    for (uint32_t k = 0; k < format_count; k++) free(formats[k]);
+    free(formats);
+    fclose(file);
+    return 0;
+}